@@ -0,0 +1,167 @@
+/*
+Benchmark for the geometry kernels that run for every point of the cloud.
+
+Usage: GeometryBench [number of points] [repetitions]
+(build it together with the sources in lib/, like tools/BuildTiles.c)
+
+Every kernel is run 'repetitions' times over the same random cloud and the fastest run is kept.
+The results are printed as JSON: the time per point (ns/op) and the number of points processed per second of every kernel
+*/
+#include <SDL3/SDL.h>
+#include <stdio.h>
+
+#include "../include/Vector3f.h"
+#include "../include/GeometryMath.h"
+#include "../include/PointRendering.h"
+#include "../include/constants.h"
+
+#define DEFAULT_BENCH_POINTS 1000000ul      // Number of points used when it isn't given
+#define DEFAULT_BENCH_REPETITIONS 5         // Number of times each kernel is run when it isn't given
+#define RANDOM_SEED 20241019ull             // Seed for the random points (so that every run measures the same cloud)
+
+
+typedef struct {
+    unsigned long nPoints;
+    Vector3f* points3d;         // Random cloud (rotated by the kernels that rotate points)
+    SDL_FPoint* projected;      // 2D points mapped with (0, 0) as the origin
+    SDL_FPoint* points2d;       // Output of the kernels that produce 2D points
+    SimplifiedPolyline polyline;
+    Vector3f cameraPos;
+    Vector3f cameraTarget;
+    Vector3f cameraUp;
+    Vector3f midPoint;
+} BenchData;
+
+typedef void (*BenchKernel)(BenchData* data);
+
+static volatile float sink;     // Written with the results of the kernels so that the compiler can't skip them
+
+
+static void benchRotate(BenchData* data) {
+    for (unsigned long i = 0; i < data->nPoints; i++) {
+        rotateVector3f(&data->points3d[i], &data->midPoint, ANGLE_STEP_DEG, ANGLE_STEP_DEG, 0.0);
+    }
+    sink = data->points3d[data->nPoints - 1].x;
+}
+
+static void benchMap(BenchData* data) {
+    for (unsigned long i = 0; i < data->nPoints; i++) {
+        data->projected[i] = map3dTo2d(&data->points3d[i], &data->cameraPos, &data->cameraTarget, &data->cameraUp, FOV_Y_DEG, 0.f, 0.f, WIN_WIDTH, WIN_HEIGHT);
+    }
+    sink = data->projected[data->nPoints - 1].x;
+}
+
+static void benchMapWithBasis(BenchData* data) {
+    const CameraBasis camera = makeCameraBasis(&data->cameraPos, &data->cameraTarget, &data->cameraUp, FOV_Y_DEG, WIN_WIDTH, WIN_HEIGHT);
+    for (unsigned long i = 0; i < data->nPoints; i++) {
+        data->projected[i] = map3dTo2dWithBasis(&data->points3d[i], &camera, 0.f, 0.f);
+    }
+    sink = data->projected[data->nPoints - 1].x;
+}
+
+static void benchRotateAndMap(BenchData* data) {
+    // Rotating every point in place and mapping it with the camera calculated for every point
+    for (unsigned long i = 0; i < data->nPoints; i++) {
+        rotateVector3f(&data->points3d[i], &data->midPoint, ANGLE_STEP_DEG, ANGLE_STEP_DEG, 0.0);
+        data->projected[i] = map3dTo2d(&data->points3d[i], &data->cameraPos, &data->cameraTarget, &data->cameraUp, FOV_Y_DEG, 0.f, 0.f, WIN_WIDTH, WIN_HEIGHT);
+    }
+    sink = data->projected[data->nPoints - 1].x;
+}
+
+static void benchRotateWithBasisAndMap(BenchData* data) {
+    // Same work as a frame of the viewer with a rotation (the points are rotated with the basis of all the rotations, not in place)
+    const Vector3f basis[3] = { makeVector3f(1, 0, 0), makeVector3f(0, 1, 0), makeVector3f(0, 0, 1) };
+    const CameraBasis camera = makeCameraBasis(&data->cameraPos, &data->cameraTarget, &data->cameraUp, FOV_Y_DEG, WIN_WIDTH, WIN_HEIGHT);
+    for (unsigned long i = 0; i < data->nPoints; i++) {
+        Vector3f p = rotateWithBasis(&data->points3d[i], basis, &data->midPoint);
+        data->projected[i] = map3dTo2dWithBasis(&p, &camera, 0.f, 0.f);
+    }
+    sink = data->projected[data->nPoints - 1].x;
+}
+
+static void benchScreenTransform(BenchData* data) {
+    applyScreenTransform(data->projected, data->points2d, data->nPoints, 1.25f, DEFAULT_ORIGIN_X(WIN_WIDTH), DEFAULT_ORIGIN_Y(WIN_HEIGHT));
+    sink = data->points2d[data->nPoints - 1].x;
+}
+
+static void benchTranslate(BenchData* data) {
+    translatePoints(data->points2d, data->nPoints, 1.f, -1.f);
+    sink = data->points2d[data->nPoints - 1].x;
+}
+
+static void benchSimplify(BenchData* data) {
+    simplifyPolyline(&data->polyline, data->points2d, data->nPoints, SIMPLIFY_TOLERANCE_PX);
+    sink = (float)data->polyline.nPoints;
+}
+
+
+/*
+Runs 'kernel' the given number of times and prints its fastest run as a JSON object
+*/
+static void runKernel(const char* name, BenchKernel kernel, BenchData* data, int repetitions, bool isLast) {
+    double bestSeconds = -1.0;
+    for (int i = 0; i < repetitions; i++) {
+        Uint64 start = SDL_GetPerformanceCounter();
+        kernel(data);
+        double seconds = (double)(SDL_GetPerformanceCounter() - start) / SDL_GetPerformanceFrequency();
+
+        if (bestSeconds < 0.0 || seconds < bestSeconds) {
+            bestSeconds = seconds;
+        }
+    }
+
+    double nsPerOp = bestSeconds * 1e9 / data->nPoints;
+    double pointsPerSecond = (bestSeconds > 0.0) ? data->nPoints / bestSeconds : 0.0;
+    printf("    { \"name\": \"%s\", \"ns_per_op\": %.3f, \"points_per_s\": %.0f }%s\n", name, nsPerOp, pointsPerSecond, isLast ? "" : ",");
+}
+
+
+int main(int argc, char* argv[]) {
+    BenchData data;
+    data.nPoints = (argc > 1) ? SDL_strtoul(argv[1], NULL, 10) : DEFAULT_BENCH_POINTS;
+    int repetitions = (argc > 2) ? SDL_atoi(argv[2]) : DEFAULT_BENCH_REPETITIONS;
+
+    if (data.nPoints == 0 || repetitions <= 0) {
+        printf("Usage: GeometryBench [number of points] [repetitions]\n");
+        return -1;
+    }
+
+    data.points3d = (Vector3f*)SDL_calloc(data.nPoints, sizeof(Vector3f));
+    data.projected = (SDL_FPoint*)SDL_calloc(data.nPoints, sizeof(SDL_FPoint));
+    data.points2d = (SDL_FPoint*)SDL_calloc(data.nPoints, sizeof(SDL_FPoint));
+    if (data.points3d == NULL || data.projected == NULL || data.points2d == NULL || !createSimplifiedPolyline(&data.polyline, data.nPoints)) {
+        perror("Unable to allocate memory for the benchmark\n");
+        return -1;
+    }
+
+    // Random cloud around the origin, seen from the default camera position
+    SDL_srand(RANDOM_SEED);
+    for (unsigned long i = 0; i < data.nPoints; i++) {
+        data.points3d[i] = makeVector3f((SDL_randf() - 0.5f) * 200.f, (SDL_randf() - 0.5f) * 200.f, (SDL_randf() - 0.5f) * 200.f);
+    }
+    data.cameraPos = makeVector3f(DEFAULT_CAM_ZVALUE, DEFAULT_CAM_ZVALUE, DEFAULT_CAM_ZVALUE);
+    data.cameraTarget = makeVector3f(0, 0, 0);
+    data.cameraUp = makeVector3f(0, 1, 0);
+    data.midPoint = makeVector3f(0, 0, 0);
+
+    // The 2D kernels need mapped points to start with
+    benchMap(&data);
+    benchScreenTransform(&data);
+
+    printf("{\n  \"points\": %lu,\n  \"repetitions\": %d,\n  \"kernels\": [\n", data.nPoints, repetitions);
+    runKernel("rotateVector3f", benchRotate, &data, repetitions, false);
+    runKernel("map3dTo2d", benchMap, &data, repetitions, false);
+    runKernel("map3dTo2dWithBasis", benchMapWithBasis, &data, repetitions, false);
+    runKernel("rotateVector3f+map3dTo2d", benchRotateAndMap, &data, repetitions, false);
+    runKernel("rotateWithBasis+map3dTo2dWithBasis", benchRotateWithBasisAndMap, &data, repetitions, false);
+    runKernel("applyScreenTransform", benchScreenTransform, &data, repetitions, false);
+    runKernel("translatePoints", benchTranslate, &data, repetitions, false);
+    runKernel("simplifyPolyline", benchSimplify, &data, repetitions, true);
+    printf("  ]\n}\n");
+
+    destroySimplifiedPolyline(&data.polyline);
+    SDL_free(data.points3d);
+    SDL_free(data.projected);
+    SDL_free(data.points2d);
+    return 0;
+}
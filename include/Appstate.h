@@ -3,13 +3,31 @@
 #include <SDL3/SDL.h>
 #include <stdbool.h>
 #include "Vector3f.h"
+#include "FileParsing.h"
+#include "PointRendering.h"
+#include "TiledCloud.h"
+#include "InputReplay.h"
+#include "RenderScaling.h"
 #include "constants.h"
 
 
+/*
+Ways in which the points can be drawn
+*/
+typedef enum {
+	DRAW_MODE_POLYLINE,		// Points are joined by lines in the order they were read (simplified in screen space)
+	DRAW_MODE_POINTS		// Only the points are drawn, without joining them (useful for unordered scans)
+} DrawMode;
+
+
 typedef struct {
 	bool checkMouse;				// To know when the user's mouse input should be registered
 	bool showDebugInfo;				// To know if the debug information (i.e. point coords, rotation info etc.) should be shown
 	bool computeTransformations;	// To ensure transformations are only computed when necessary and not in all the frames
+	bool computeScreenTransform;	// To apply pans and zooms to the already mapped points without mapping them from 3D again
+	DrawMode drawMode;				// To know how the points should be drawn
+	Uint32 pressedKeys;				// INPUT_KEY_* bits of the keys pressed since the last frame
+	float wheelY;					// Vertical movement of the mouse wheel since the last frame
 	SDL_FPoint oldMousePos;			// To compare with the actual mouse position if needed to calculate difference in position
 } InOutHandle;
 
@@ -22,6 +40,10 @@ inline InOutHandle defaultInOutHandle() {
 	ioHandle.checkMouse = false;
 	ioHandle.showDebugInfo = false;
 	ioHandle.computeTransformations = false;
+	ioHandle.computeScreenTransform = false;
+	ioHandle.drawMode = DRAW_MODE_POLYLINE;
+	ioHandle.pressedKeys = 0;
+	ioHandle.wheelY = 0.f;
 	SDL_GetMouseState(&ioHandle.oldMousePos.x, &ioHandle.oldMousePos.y);
 
 	return ioHandle;
@@ -30,13 +52,23 @@ inline InOutHandle defaultInOutHandle() {
 
 typedef struct {
 	Vector3f rotationAngles;			// Angles (in degrees) that the points have been rotated around each axis
+	Vector3f rotationBasis[3];			// Where the x, y and z unit vectors end up after all the rotations (points are never rotated in place, this is applied when mapping them)
 	float zCamValue;					// Z Value for the camera (i.e. zoom)
+	const char* pointsFname;			// File from which the points are read
 	unsigned long nPoints;				// Number of points read from the file
 	Vector3f midPoint;					// 'Average' point (i.e. point supposedly in the middle of all the points)
 	SDL_FPoint originXY;				// Origin coordinates (i.e. 2D point in the screen where the (0, 0, 0) coordinate is drawn)
 
-	Vector3f* pointsArray_3d;			// Array containing points to be drawn (in 3D), MUST BE INITIALIZED WITH AN ARRAY OF POINTS BEFORE USE
-	SDL_FPoint* pointsArray;			// 2D mapping of the 3D array, MUST BE INITIALIZED WITH AN ARRAY OF POINTS BEFORE USE
+	Vector3f* pointsArray_3d;			// Array containing points to be drawn (in 3D, without any rotation), MUST BE INITIALIZED WITH AN ARRAY OF POINTS BEFORE USE
+	SDL_FPoint* pointsArray;			// 2D mapping of one of every projectedStride points of the 3D array, MUST BE INITIALIZED WITH AN ARRAY OF POINTS BEFORE USE
+	SDL_FPoint* pointsArrayProjected;	// 2D mapping of the 3D array with (0, 0) as origin and projectedCamValue as camera Z value, pointsArray is obtained from it through pans and zooms. MUST BE INITIALIZED WITH AN ARRAY OF POINTS BEFORE USE
+	unsigned long nProjected;			// Number of points in pointsArrayProjected and pointsArray
+	unsigned long projectedStride;		// One of every 'projectedStride' points of the 3D array is mapped to 2D (so that the point budget is met)
+	float projectedCamValue;			// Camera Z value used when pointsArrayProjected was calculated
+	float drawnScale;					// Scale applied to pointsArrayProjected to obtain pointsArray
+	SDL_FPoint drawnOriginXY;			// Origin coordinates used to obtain pointsArray
+	float boundingRadius;				// Radius of a sphere centered in (0, 0, 0) that contains all the points (no matter how they are rotated)
+	PointAttributes attributes;			// Optional per-point attributes (i.e. colors or scalars), indexed alongside pointsArray_3d
 } GeometryHandle;
 
 /*
@@ -44,15 +76,29 @@ Returns a GeometryHandle element initialized with the default values. NONE OF TH
 */
 inline GeometryHandle defaultGeometryHandle() {
 	SDL_FPoint defaultOrigin;
-	defaultOrigin.x = DEFAULT_ORIGIN_X;
-	defaultOrigin.y = DEFAULT_ORIGIN_Y;
+	defaultOrigin.x = DEFAULT_ORIGIN_X(WIN_WIDTH);
+	defaultOrigin.y = DEFAULT_ORIGIN_Y(WIN_HEIGHT);
 
 	GeometryHandle geoHandle;
 	geoHandle.rotationAngles = makeVector3f(0, 0, 0);
+	geoHandle.rotationBasis[0] = makeVector3f(1, 0, 0);
+	geoHandle.rotationBasis[1] = makeVector3f(0, 1, 0);
+	geoHandle.rotationBasis[2] = makeVector3f(0, 0, 1);
+	geoHandle.pointsFname = POINTS_FNAME;
 	geoHandle.zCamValue = DEFAULT_CAM_ZVALUE;
 	geoHandle.nPoints = 0ul;
 	geoHandle.midPoint = makeVector3f(0, 0, 0);
 	geoHandle.originXY = defaultOrigin;
+	geoHandle.nProjected = 0ul;
+	geoHandle.projectedStride = 1ul;
+	geoHandle.projectedCamValue = DEFAULT_CAM_ZVALUE;
+	geoHandle.drawnScale = 1.f;
+	geoHandle.drawnOriginXY = defaultOrigin;
+	geoHandle.boundingRadius = 0.f;
+	geoHandle.attributes.type = POINT_ATTRIBUTES_NONE;
+	geoHandle.attributes.scalars = NULL;
+	geoHandle.attributes.colors = NULL;
+	geoHandle.attributes.minScalar = geoHandle.attributes.maxScalar = 0.f;
 
 	return geoHandle;
 }
@@ -86,5 +132,10 @@ typedef struct {
 	InOutHandle ioHandle;		// Struct containing elements useful for IO management in the program
 	GeometryHandle geoHandle;	// Struct containing elements useful for geometry management (i.e. points, rotations etc.) in the program
 	Axes axesSet;				// Struct containing the set of (3D) axes that are to be drawn in the window
+	PointBatch pointBatch;		// Vertices used to draw colored points in a single call (only used if the points have attributes)
+	SimplifiedPolyline polyline;	// Screen space simplification of the lines joining the points (only used in DRAW_MODE_POLYLINE)
+	TileCache* tileCache;		// Tiles of the points kept in memory (NULL unless the points are read from a tiled file)
+	InputLog inputLog;			// Recording (or replay) of the input of every frame
+	RenderScaler scaler;		// Window size, internal resolution and point budget
 
 } Appstate;
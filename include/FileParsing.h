@@ -1,17 +1,47 @@
 #pragma once
 
+#include <SDL3/SDL.h>
 #include <stdio.h>
 #include "Vector3f.h"
 #include "constants.h"
 
+/*
+Kind of optional per-point attribute found after the x, y, z values of each line in a points file
+*/
+typedef enum {
+	POINT_ATTRIBUTES_NONE,		// Lines only contain 'x, y, z'
+	POINT_ATTRIBUTES_SCALAR,	// Lines contain 'x, y, z, s' where s is a scalar (i.e. intensity) that is mapped to a color through a colormap
+	POINT_ATTRIBUTES_RGB		// Lines contain 'x, y, z, r, g, b' where r, g and b are in the [0, 255] range
+} PointAttributeType;
+
+/*
+Struct holding the optional per-point attributes read from a points file. Every array has one element per point
+(i.e. the same length as the points array) so that they can be indexed alongside it.
+*/
+typedef struct {
+	PointAttributeType type;	// Kind of attributes read from the file
+	float* scalars;				// Scalar value of every point (only if type is POINT_ATTRIBUTES_SCALAR, NULL otherwise)
+	SDL_FColor* colors;			// Color of every point, either read from the file or obtained from the scalars (NULL if type is POINT_ATTRIBUTES_NONE)
+	float minScalar;			// Smallest scalar read from the file (used as the bottom of the colormap)
+	float maxScalar;			// Biggest scalar read from the file (used as the top of the colormap)
+} PointAttributes;
+
 /*
 Function that receives a string (char[]) containing 3 numbers (float, int, double etc.) separated by commas
 and returns a Vector3f element containing these numbers in the x, y, z fields in the order they appeared in the string
 */
 Vector3f strToVector3f(const char* str, unsigned long lineNumForDebug);
 
+/*
+Function that receives the same kind of string as strToVector3f and stores in 'values' the numbers (up to 'maxValues')
+that appear after the first 3, returning how many of them were found
+*/
+unsigned strToAttributes(const char* str, float values[], unsigned maxValues);
+
 /*
 Function that reads the file specified by 'fname' and returns a pointer to an array of Vector3f's that
-represent the points read from said file
+represent the points read from said file.
+If 'attributes' is not NULL, the optional per-point attributes found in the file are also stored in it. For scalar attributes
+the colors array is allocated but left empty, as filling it is up to the colormap. The arrays inside it must be freed with SDL_free.
 */
-Vector3f* readPointsFromFile(unsigned long* n, const char* fname);
\ No newline at end of file
+Vector3f* readPointsFromFile(unsigned long* n, const char* fname, PointAttributes* attributes);
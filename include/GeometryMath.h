@@ -9,6 +9,33 @@ Function that calculates the middle or 'average' point from a given array of poi
 */
 Vector3f getPointsCenter(Vector3f points[], unsigned count);
 
+/*
+Struct holding everything map3dTo2d needs to know about the camera, so that it can be calculated once for all the points mapped in a frame
+*/
+typedef struct {
+    Vector3f position;                  // Position of the camera in 3D space
+    Vector3f forward;                   // Unit vector in the direction the camera looks at
+    Vector3f right;                     // Unit vector pointing to the right of the camera
+    Vector3f up;                        // Unit vector pointing upwards from the camera
+    double f_x, f_y;                    // Focal lengths (in pixels) along each screen axis
+} CameraBasis;
+
+/*
+Function that calculates the camera basis used to map points to 2D for this specific set of parameters
+*/
+CameraBasis makeCameraBasis(
+    const Vector3f* cameraPos,          // Position of the camera in 3D space
+    const Vector3f* cameraTarget,       // Target point that the camera is looking at
+    const Vector3f* cameraUpDirection,  // Vector that indicates the 'up' direction
+    double y_fov_deg,                   // Camera field of view in degrees
+    int screenWidth, int screenHeight   // Screen dimensions in pixels
+);
+
+/*
+Function that receives a point in 3D and returns its 2D equivalent as seen by 'camera' (same result as map3dTo2d with the parameters of the camera)
+*/
+SDL_FPoint map3dTo2dWithBasis(const Vector3f* pt, const CameraBasis* camera, float originX, float originY);
+
 /*
 Function that receives a point in 3D and returns its 2D equivalent for this specific set of parameters
 */
@@ -25,4 +52,35 @@ SDL_FPoint map3dTo2d(
 /*
 Function that rotates a point in 3D around the given origin, and along each axis the given number of degrees (i.e. x_deg is the amount of degrees rotated around the x axis)
 */
-bool rotateVector3f(Vector3f* p, const Vector3f* origin, double x_deg, double y_deg, double z_deg);
\ No newline at end of file
+bool rotateVector3f(Vector3f* p, const Vector3f* origin, double x_deg, double y_deg, double z_deg);
+
+/*
+Function that returns the point p after applying all the rotations described by 'basis' (i.e. where the x, y and z unit vectors end up
+after them) around 'midPoint'. Used to rotate points without changing them, so that only the ones that are drawn have to be rotated
+*/
+Vector3f rotateWithBasis(const Vector3f* p, const Vector3f basis[3], const Vector3f* midPoint);
+
+/*
+Function that applies a screen space transformation to points that were mapped to 2D with map3dTo2d using (0, 0) as the origin:
+they are scaled by 'scale' and then moved so that the origin ends up at (originX, originY)
+*/
+void applyScreenTransform(const SDL_FPoint projected[], SDL_FPoint out[], unsigned long count, float scale, float originX, float originY);
+
+/*
+Function that moves every point in the array 'dx' pixels to the right and 'dy' pixels down
+*/
+void translatePoints(SDL_FPoint points[], unsigned long count, float dx, float dy);
+
+/*
+Function that returns true if moving the camera (along the direction it looks at) from 'oldDistance' to 'newDistance' away from its target
+can be approximated by scaling the already mapped points, with an error smaller than 'tolerancePx' pixels.
+'boundingRadius' is the radius of a sphere centered in the camera target that contains all the points
+*/
+bool isZoomScalable(
+    float boundingRadius,               // Radius of the sphere (centered in the camera target) that contains all the points
+    double oldDistance,                 // Distance from the camera to its target when the points were mapped
+    double newDistance,                 // Distance from the camera to its target now
+    double y_fov_deg,                   // Camera field of view in degrees
+    int screenWidth, int screenHeight,  // Screen dimensions in pixels
+    float tolerancePx                   // Maximum error allowed (in pixels)
+);
\ No newline at end of file
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <SDL3/SDL.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "Vector3f.h"
+#include "constants.h"
+
+/*
+Bits used in FrameInput to mark which keys are held or were pressed
+*/
+#define INPUT_KEY_W (1u << 0)
+#define INPUT_KEY_S (1u << 1)
+#define INPUT_KEY_A (1u << 2)
+#define INPUT_KEY_D (1u << 3)
+#define INPUT_KEY_LSHIFT (1u << 4)
+#define INPUT_KEY_R (1u << 5)
+#define INPUT_KEY_TAB (1u << 6)
+#define INPUT_KEY_P (1u << 7)
+
+/*
+Struct holding all the input that affects the program in a single frame, either read live or from a recording
+*/
+typedef struct {
+	Uint64 ticks;				// Time (in ms) at which the frame started
+	Uint32 heldKeys;			// INPUT_KEY_* bits of the keys held during the frame
+	Uint32 pressedKeys;			// INPUT_KEY_* bits of the keys pressed since the last frame (for toggles)
+	SDL_FPoint mousePos;		// Position of the mouse
+	bool mouseDown;				// If a mouse button is held
+	float wheelY;				// Vertical movement of the mouse wheel since the last frame
+} FrameInput;
+
+/*
+Struct holding the state of the camera after a frame, used to check that a replay does the same as the recording
+*/
+typedef struct {
+	Vector3f rotationAngles;	// Angles (in degrees) that the points have been rotated around each axis
+	float zCamValue;			// Z Value for the camera (i.e. zoom)
+	SDL_FPoint originXY;		// Origin coordinates in the screen
+} CameraState;
+
+/*
+Struct used to record the input of every frame to a file, or to feed it back from one
+*/
+typedef struct {
+	FILE* file;					// File the input is written to or read from (NULL if not recording nor replaying)
+	bool isRecording;			// If the input of every frame is written to the file
+	bool isReplaying;			// If the input of every frame is read from the file instead of the keyboard and mouse
+	Uint64 frame;				// Number of frames recorded or replayed
+	int windowWidth;			// Width (in pixels) of the window while recording, which replays have to use too
+	int windowHeight;			// Height (in pixels) of the window while recording, which replays have to use too
+	unsigned long mismatches;	// Number of replayed frames that ended with a different camera state than in the recording
+	bool isCorrupt;				// If the replay stopped at a line of the recording that is not a complete frame
+	const char* timingsFname;	// File where the time taken by every replayed frame is written (NULL if it isn't needed)
+
+	double* frameTimes;			// Time (in ms) taken by every replayed frame
+	unsigned long capacity;		// Number of elements that fit in frameTimes
+} InputLog;
+
+/*
+Function that opens the file specified by 'fname' to write the input of every frame in it, starting with the window size in pixels
+and the mouse position before the first frame. Returns false if the file could not be opened
+*/
+bool openInputRecording(InputLog* log, const char* fname, const SDL_FPoint* startMousePos, int windowWidth, int windowHeight);
+
+/*
+Function that opens the file specified by 'fname' to read the input of every frame from it, storing in 'startMousePos' the mouse
+position before the first frame (and the window size of the recording in the log). Returns false if the file could not be opened
+*/
+bool openInputReplay(InputLog* log, const char* fname, SDL_FPoint* startMousePos);
+
+/*
+Function that writes the input of a frame, along with the camera state it resulted in, to the recording
+*/
+void recordFrameInput(InputLog* log, const FrameInput* input, const CameraState* state);
+
+/*
+Function that reads the input of the next frame (and the camera state it should result in) from the recording.
+Returns false when there are no more frames, or when the next line is not a complete frame (in which case the log is marked as corrupt)
+*/
+bool readFrameInput(InputLog* log, FrameInput* input, CameraState* expected);
+
+/*
+Function that compares the camera state after a replayed frame with the one in the recording, and stores how long the frame took
+*/
+void checkReplayedFrame(InputLog* log, const CameraState* state, const CameraState* expected, double frameMs);
+
+/*
+Function that continues a 64 bit FNV-1a hash ('hash') with 'size' bytes from 'data'. Use FNV_OFFSET_BASIS to start a new hash
+*/
+Uint64 hashBytes(Uint64 hash, const void* data, size_t size);
+
+/*
+Function that prints the timings of the replayed frames and the checksum of the final state. If the log has a timings file,
+the time taken by every frame is also written to it (one per line).
+Returns false if the recording was corrupt or any frame ended with a different camera state than in the recording
+*/
+bool printReplayReport(const InputLog* log, Uint64 checksum);
+
+/*
+Function that closes the file of the log and frees its memory
+*/
+void closeInputLog(InputLog* log);
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <SDL3/SDL.h>
+#include <stdbool.h>
+#include "constants.h"
+
+/*
+Struct holding the vertices used to draw every point as a small colored square in a single SDL_RenderGeometry call.
+The vertices are kept between frames so that they only have to be rebuilt when the 2D points change.
+*/
+typedef struct {
+	SDL_Vertex* vertices;		// 4 vertices (i.e. the corners of a square) per point
+	int* indices;				// 6 indices (i.e. 2 triangles) per point, these never change once created
+	const SDL_FColor* colors;	// Colors of every point (not owned by the batch)
+	unsigned long capacity;		// Number of points the batch was created for
+	unsigned long nPoints;		// Number of points currently in the batch
+	unsigned long stride;		// One of every 'stride' points is in the batch (their colors are set accordingly)
+	bool isValid;				// False when the vertices must be rebuilt before drawing the batch again
+} PointBatch;
+
+/*
+Struct holding a simplified (in screen space) version of a polyline, along with the scratch memory used to simplify it.
+The simplified polyline is kept between frames so that it only has to be recomputed when the 2D points change.
+*/
+typedef struct {
+	SDL_FPoint* points;			// Vertices of the simplified polyline
+	unsigned long nPoints;		// Number of vertices in the simplified polyline
+	unsigned long capacity;		// Maximum number of vertices the buffers can hold (i.e. number of vertices of the original polyline)
+	bool* keep;					// Scratch array that marks which vertices survive the simplification
+	unsigned long* stack;		// Scratch array of (first, last) index pairs pending to be simplified
+	bool isValid;				// False when the polyline must be simplified again before drawing it
+} SimplifiedPolyline;
+
+/*
+Function that returns the color assigned by the colormap to 'value', where 'minValue' is mapped to the bottom of the colormap
+and 'maxValue' to the top of it
+*/
+SDL_FColor colormapScalar(float value, float minValue, float maxValue);
+
+/*
+Function that fills the 'colors' array with the colormap equivalent of every element in the 'scalars' array
+*/
+void applyColormap(const float scalars[], SDL_FColor colors[], unsigned long count, float minValue, float maxValue);
+
+/*
+Function that allocates the buffers of 'batch' for 'nPoints' points with the given colors. Returns false if the memory could not be allocated.
+The positions of the vertices are not set, so the batch starts as invalid
+*/
+bool createPointBatch(PointBatch* batch, const SDL_FColor colors[], unsigned long nPoints);
+
+/*
+Function that moves the vertices of 'batch' so that they form squares of 'pointSize' pixels centered on each of the 'nPoints' 2D points,
+which are one of every 'stride' points the batch was created for (i.e. when there are more points than the point budget allows)
+*/
+void updatePointBatch(PointBatch* batch, const SDL_FPoint points[], unsigned long nPoints, unsigned long stride, float pointSize);
+
+/*
+Function that moves the vertices of 'batch' 'dx' pixels to the right and 'dy' pixels down (i.e. when the points are only panned)
+*/
+void translatePointBatch(PointBatch* batch, float dx, float dy);
+
+/*
+Function that draws every point in 'batch' with a single call to the renderer
+*/
+void drawPointBatch(SDL_Renderer* r, const PointBatch* batch);
+
+/*
+Function that frees the buffers of 'batch'
+*/
+void destroyPointBatch(PointBatch* batch);
+
+/*
+Function that allocates the buffers of 'polyline' for polylines of up to 'capacity' vertices. Returns false if the memory could not be allocated
+*/
+bool createSimplifiedPolyline(SimplifiedPolyline* polyline, unsigned long capacity);
+
+/*
+Function that stores in 'polyline' a simplified version of the polyline formed by 'points', so that it never deviates from the original
+by more than (roughly) 'tolerancePx' pixels. Runs of segments shorter than the tolerance are merged first, and then vertices that are
+(almost) collinear with their neighbours are dropped (Douglas-Peucker)
+*/
+void simplifyPolyline(SimplifiedPolyline* polyline, const SDL_FPoint points[], unsigned long count, float tolerancePx);
+
+/*
+Function that frees the buffers of 'polyline'
+*/
+void destroySimplifiedPolyline(SimplifiedPolyline* polyline);
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <SDL3/SDL.h>
+#include <stdbool.h>
+#include "constants.h"
+
+/*
+Struct holding the size of the window and the internal resolution everything is drawn at, which is lowered (along with the number of points
+drawn) when frames take longer than they should and restored when the view stops changing.
+Drawing coordinates are always in window pixels, the renderer scale takes care of fitting them in the internal resolution
+*/
+typedef struct {
+	int windowWidth;				// Width of the window in pixels
+	int windowHeight;				// Height of the window in pixels
+	float renderScale;				// Internal resolution relative to the window size (1 means drawing at full resolution)
+	bool isScaleFixed;				// If true, the internal resolution is never changed (only the point budget is adapted)
+	double targetFrameMs;			// Time (in ms) that frames should take at most
+	SDL_Texture* target;			// Texture everything is drawn to before stretching it to the window (NULL when drawing at full resolution)
+	Uint64 pointBudget;				// Maximum number of points (or polyline vertices) drawn per frame (SDL_MAX_UINT64 means no budget)
+	double frameTimeMs;				// Moving average of the time taken by every frame
+	unsigned framesSinceChange;		// Frames since the quality was last changed (to give every change time to take effect)
+	unsigned idleFrames;			// Consecutive frames in which the view didn't change
+} RenderScaler;
+
+/*
+Returns a RenderScaler element initialized for a window of the given size, drawing at full resolution without any point budget
+and aiming for frames of MS_PER_FRAME ms
+*/
+inline RenderScaler defaultRenderScaler(int windowWidth, int windowHeight) {
+	RenderScaler scaler;
+	scaler.windowWidth = windowWidth;
+	scaler.windowHeight = windowHeight;
+	scaler.renderScale = 1.f;
+	scaler.isScaleFixed = false;
+	scaler.targetFrameMs = MS_PER_FRAME;
+	scaler.target = NULL;
+	scaler.pointBudget = SDL_MAX_UINT64;
+	scaler.frameTimeMs = 0.0;
+	scaler.framesSinceChange = 0;
+	scaler.idleFrames = 0;
+	return scaler;
+}
+
+/*
+Function that changes the window size the scaler works with (i.e. when the window is resized). Returns false if the texture for the
+internal resolution could not be created
+*/
+bool resizeRenderScaler(RenderScaler* scaler, SDL_Renderer* r, int windowWidth, int windowHeight);
+
+/*
+Function that sets the internal resolution to 'renderScale' (relative to the window size, at most 1) and keeps it there, so that only the
+point budget is adapted afterwards. Returns false if the texture for the internal resolution could not be created
+*/
+bool fixRenderScale(RenderScaler* scaler, SDL_Renderer* r, float renderScale);
+
+/*
+Function that makes the renderer draw at the internal resolution. Must be called before drawing anything in a frame
+*/
+void beginScaledFrame(const RenderScaler* scaler, SDL_Renderer* r);
+
+/*
+Function that stretches what was drawn at the internal resolution to the window. Must be called before presenting the frame
+*/
+void endScaledFrame(const RenderScaler* scaler, SDL_Renderer* r);
+
+/*
+Function that adapts the internal resolution and point budget to the time taken by the last frame ('frameMs'), so that frames take
+less than 'targetFrameMs'.
+'isIdle' tells if the view changed in the last frame, and 'nPoints' is the number of points that can be drawn
+*/
+void updateRenderScaler(RenderScaler* scaler, SDL_Renderer* r, double frameMs, bool isIdle, Uint64 nPoints);
+
+/*
+Function that returns how many points have to be skipped for every point drawn (1 means none) so that drawing 'count' points stays within the budget
+*/
+Uint64 budgetStride(const RenderScaler* scaler, Uint64 count);
+
+/*
+Function that frees the texture of the scaler
+*/
+void destroyRenderScaler(RenderScaler* scaler);
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <SDL3/SDL.h>
+#include <stdbool.h>
+#include "Vector3f.h"
+#include "GeometryMath.h"
+#include "constants.h"
+
+/*
+Header found at the start of every tiled points file (generated by tools/BuildTiles.c).
+It is followed by 'nTiles' TileIndexEntry elements and then by the points of every tile, stored as packed Vector3f's
+*/
+typedef struct {
+	char magic[4];				// Always TILED_FILE_MAGIC, used to tell tiled files apart from text ones
+	Uint32 nTiles;				// Number of tiles (i.e. spatial chunks) in the file
+	Uint64 nPoints;				// Total number of points in the file
+	Vector3f minCorner;			// Smallest x, y, z values of all the points
+	Vector3f maxCorner;			// Biggest x, y, z values of all the points
+	Vector3f midPoint;			// Average of all the points
+	Uint32 reserved;			// Unused, keeps the size of the header a multiple of 8
+} TiledFileHeader;
+
+/*
+Entry of the index of a tiled points file, describing where a tile is and which space it covers
+*/
+typedef struct {
+	Vector3f minCorner;			// Smallest x, y, z values of the points in the tile
+	Vector3f maxCorner;			// Biggest x, y, z values of the points in the tile
+	Uint64 offset;				// Position (in bytes from the start of the file) of the first point of the tile
+	Uint32 nPoints;				// Number of points in the tile
+	Uint32 reserved;			// Unused, keeps the size of the entry a multiple of 8
+} TileIndexEntry;
+
+/*
+States in which a tile can be inside the cache
+*/
+typedef enum {
+	TILE_UNLOADED,				// Points are only on disk
+	TILE_REQUESTED,				// Points are queued for (or being read by) the reader thread, their memory is already accounted for
+	TILE_RESIDENT,				// Points are in memory and can be drawn
+	TILE_FAILED					// Points could not be read, the tile is never requested again
+} TileState;
+
+typedef struct {
+	TileIndexEntry entry;		// Where the tile is in the file and which space it covers
+	TileState state;			// Whether the points of the tile are in memory or not
+	Vector3f* points;			// Points of the tile (NULL unless the tile is resident)
+	SDL_FPoint* projected;		// 2D points of the tile as they were drawn last (NULL unless the tile is resident)
+	Uint32 nProjected;			// Number of 2D points in 'projected'
+	Uint32 projectedStride;		// One of every 'projectedStride' points of the tile was mapped to 2D
+	Uint32 projectedVersion;	// Value of the 'projectionVersion' of the cache when the tile was mapped to 2D (0 if it never was)
+	SDL_FPoint projectedOrigin;	// 2D origin of the points in 'projected' (pans only move them, they are not mapped again)
+	Uint64 lastUsedFrame;		// Last frame in which the tile was visible (used to evict the least recently used tiles first)
+	bool isVisible;				// If the tile was visible in the current frame
+	bool isDrawable;			// If the tile was visible and in memory in the current frame
+} Tile;
+
+/*
+Struct holding everything needed to draw a tiled points file while only keeping part of it in memory.
+Tiles are read in the background by a separate thread and the least recently used ones are freed when the memory limit is reached
+*/
+typedef struct {
+	TiledFileHeader header;		// Header of the tiled file
+	Tile* tiles;				// Every tile in the file
+	Uint64 residentBytes;		// Memory (in bytes) used by the points (3D and 2D) of resident and requested tiles
+	Uint64 maxResidentBytes;	// Limit for residentBytes, it is never exceeded
+	Uint64 frame;				// Number of frames drawn, used as the clock for the LRU policy
+	Uint32 nResidentTiles;		// Number of tiles whose points are in memory
+
+	SDL_IOStream* file;			// Tiled file, only used by the reader thread once the cache is open
+	SDL_Thread* reader;			// Thread that reads the requested tiles from the file
+	SDL_Mutex* lock;			// Protects the tile states, the requests queue and 'quit'
+	SDL_Condition* hasRequests;	// Signaled whenever a tile is requested (or the reader has to quit)
+	Uint32* requests;			// Circular queue of the indices of the requested tiles
+	Uint32 requestsStart;		// Position of the first pending request in the queue
+	Uint32 nRequests;			// Number of pending requests in the queue
+	bool quit;					// Tells the reader thread to stop
+
+	CameraBasis projectionCamera;	// Camera with which the 2D points of the tiles were mapped
+	Vector3f projectionRotation[3];	// Rotations with which the 2D points of the tiles were mapped
+	Uint32 projectionVersion;		// Increased every time the view changes, so that the 2D points of every tile are mapped again
+} TileCache;
+
+/*
+Parameters that define how the points of a tiled file are seen in the screen
+*/
+typedef struct {
+	const Vector3f* rotationBasis;	// Array of 3 vectors: where the x, y and z unit vectors end up after all the rotations
+	const Vector3f* midPoint;		// Point around which the rotations happen
+	const Vector3f* cameraPos;		// Position of the camera in 3D space
+	const Vector3f* cameraTarget;	// Target point that the camera is looking at
+	const Vector3f* cameraUp;		// Vector that indicates the 'up' direction
+	float originX, originY;			// 2D origin coordinates in the screen
+	int screenWidth, screenHeight;	// Screen dimensions in pixels
+} TileView;
+
+/*
+Function that returns true if the file specified by 'fname' is a tiled points file
+*/
+bool isTiledFile(const char* fname);
+
+/*
+Function that opens the tiled file specified by 'fname', reading only its header and index, and starts the thread that reads
+its tiles. Returns NULL if the file could not be opened. At most 'maxResidentBytes' bytes of points (including their 2D positions) will be kept in memory
+*/
+TileCache* openTileCache(const char* fname, Uint64 maxResidentBytes);
+
+/*
+Function that draws the points of every visible tile that is in memory and requests the visible tiles that are not.
+The 2D points of every tile are kept, and they are only mapped again when the view changes (pans just move them).
+If there are more than 'pointBudget' points to draw, only some of the points of every tile are drawn. Returns the number of points drawn
+*/
+Uint64 drawTileCache(TileCache* cache, SDL_Renderer* r, const TileView* view, Uint64 pointBudget);
+
+/*
+Function that stops the reader thread and frees everything in the cache (including the cache itself)
+*/
+void closeTileCache(TileCache* cache);
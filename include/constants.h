@@ -3,22 +3,46 @@
 /*
 Definitions
 */
-#define WIN_WIDTH 1000u									// Drawing window width in pixels
-#define WIN_HEIGHT 600u									// Drawing window height in pixels
+#define WIN_WIDTH 1000u									// Drawing window width in pixels (when it is created, it can be resized afterwards)
+#define WIN_HEIGHT 600u									// Drawing window height in pixels (when it is created, it can be resized afterwards)
 
-#define DEFAULT_ORIGIN_X WIN_WIDTH / 2.f				// Default X coordinates where the 3D origin will appear in the screen
-#define DEFAULT_ORIGIN_Y -(WIN_HEIGHT / 2.f)			// Default Y coordinates where the 3D origin will appear in the screen
+#define DEFAULT_ORIGIN_X(width) ((width) / 2.f)			// Default X coordinates where the 3D origin will appear in a screen 'width' pixels wide
+#define DEFAULT_ORIGIN_Y(height) (-((height) / 2.f))	// Default Y coordinates where the 3D origin will appear in a screen 'height' pixels high
 
 #define POINTS_FNAME "points.pts"						// File from which the points will be read (to avoid having to enter it every time the program is opened)
 
+#define TILED_FILE_MAGIC "PTT1"							// First 4 bytes of every tiled points file (see tools/BuildTiles.c)
+#define DEFAULT_TILE_CACHE_MB 512u						// Default limit (in MB) for the points of a tiled file kept in memory (can be changed with '--cache-mb')
+#define MAX_TILE_CACHE_MB (1024u * 1024u)				// Biggest value accepted for '--cache-mb' (1 TB)
+#define MAX_TILE_REQUESTS_PER_FRAME 16u					// Maximum number of tiles that are requested to the reader thread in a single frame
+#define TILE_TARGET_POINTS 65536u						// Average number of points per tile that tools/BuildTiles.c aims for
+#define TILE_MAX_POINTS (4 * TILE_TARGET_POINTS)		// Number of points in a cell above which tools/BuildTiles.c splits it into smaller cells
+#define TILE_GRID_MAX 32u								// Maximum number of tiles along each axis in tools/BuildTiles.c
+
+#define RECORDING_HEADER "3DPV-INPUT 2"					// First line of every input recording (see '--record' and '--replay')
+#define FNV_OFFSET_BASIS 14695981039346656037ull		// Starting value of the FNV-1a hash used for the checksum at the end of a replay
+
 #define FPS 120u										// Maximum frames per second that will be rendered
 #define MS_PER_FRAME (1000/FPS)							// Time (in ms) for each frame
 
+#define MIN_RENDER_SCALE 0.5f							// Lowest internal resolution (relative to the window size) used when frames take too long
+#define RENDER_SCALE_STEP 0.125f						// Amount the internal resolution changes by every time it is adapted
+#define MIN_POINT_BUDGET 100000ul						// Lowest number of points drawn per frame when frames take too long
+#define FRAME_TIME_SMOOTHING 0.1						// Weight of the last frame in the moving average of the frame time
+#define ADAPT_INTERVAL_FRAMES 30u						// Frames to wait between changes of the internal resolution or point budget
+#define RESTORE_FRAME_TIME_FRACTION 0.6					// Quality is raised while interacting if frames take less than this fraction of the target frame time
+#define IDLE_FRAMES_TO_RESTORE (FPS / 2u)		// Frames without changes in the view after which the full quality is restored (half a second at FPS)
+
 #define BG_COLOR 0x10, 0x10, 0x10, SDL_ALPHA_OPAQUE		// Default background color (in RGB format)
 
 #define DEFAULT_CAM_ZVALUE 600.f						// Default Z coordinates of the camera's position
 #define FOV_Y_DEG 10.f									// Camera's field of view (in degrees)
 
+#define POINT_SIZE_PX 3.f								// Size (in pixels) of the squares used to draw points that have a color
+
+#define ZOOM_SCALE_TOLERANCE_PX 0.5f					// Maximum error (in pixels) allowed when a zoom is applied by scaling the 2D points instead of mapping them again
+#define SIMPLIFY_TOLERANCE_PX 0.5f						// Maximum distance (in pixels) that the simplified polyline can deviate from the original one
+
 #define ANGLE_STEP_DEG 1.f								// Amount (in degrees) that the shape will be rotated in the specified direction for every frame with button press
 
 #define TO_RAD_CONSTANT 3.141592 / 180.0				// Multiply by this to convert from deg to rad
\ No newline at end of file
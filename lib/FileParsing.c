@@ -38,16 +38,101 @@ Vector3f strToVector3f(const char* str, unsigned long lineNumForDebug) {
     v.y = (float)atof(numBuffer);
 
     numBuffer[0] = '\0';
-    size_t endOfFilePos = (size_t)(str + lineLength);
-    strncpy(numBuffer, str + comma2 + 1, lineLength - comma2);
-    numBuffer[lineLength] = '\0';
+    // The z value ends either at the end of the line or at the comma that starts the optional attributes
+    tempPtr = strchr(tempPtr + 1, ',');
+    size_t zEnd = (tempPtr == NULL) ? lineLength : (size_t)(tempPtr - str);
+    strncpy(numBuffer, str + comma2 + 1, zEnd - comma2 - 1);
+    numBuffer[zEnd - comma2 - 1] = '\0';
     v.z = (float)atof(numBuffer);
 
     return v;
 }
 
 
-Vector3f* readPointsFromFile(unsigned long* n, const char* fname) {
+unsigned strToAttributes(const char* str, float values[], unsigned maxValues) {
+    unsigned count = 0;
+
+    // Skipping the x, y, z values (i.e. the first 2 commas)
+    const char* tempPtr = strchr(str, ',');
+    if (tempPtr != NULL) {
+        tempPtr = strchr(tempPtr + 1, ',');
+    }
+
+    // Every comma found after those marks the start of a new attribute value
+    while (tempPtr != NULL && count < maxValues) {
+        tempPtr = strchr(tempPtr + 1, ',');
+        if (tempPtr != NULL) {
+            values[count] = (float)atof(tempPtr + 1);
+            count++;
+        }
+    }
+
+    return count;
+}
+
+
+/*
+Allocates the arrays in 'attributes' for the kind of attributes that corresponds to lines with 'nValues' values after x, y, z
+*/
+static void initPointAttributes(PointAttributes* attributes, unsigned nValues, unsigned long lines) {
+    attributes->scalars = NULL;
+    attributes->colors = NULL;
+    attributes->minScalar = 0.f;
+    attributes->maxScalar = 0.f;
+
+    if (nValues == 1) {
+        attributes->type = POINT_ATTRIBUTES_SCALAR;
+        attributes->scalars = (float*)SDL_calloc(lines, sizeof(float));
+    }
+    else if (nValues == 3) {
+        attributes->type = POINT_ATTRIBUTES_RGB;
+    }
+    else {
+        attributes->type = POINT_ATTRIBUTES_NONE;
+        return;
+    }
+
+    attributes->colors = (SDL_FColor*)SDL_calloc(lines, sizeof(SDL_FColor));
+
+    if (attributes->colors == NULL || (attributes->type == POINT_ATTRIBUTES_SCALAR && attributes->scalars == NULL)) {
+        perror("Unable to allocate memory for point attributes\n");
+        exit(-1);
+    }
+}
+
+/*
+Stores the attribute values read from line 'i' in the corresponding arrays of 'attributes'
+*/
+static void storePointAttributes(PointAttributes* attributes, unsigned long i, const float values[], unsigned nValues) {
+    if (attributes->type == POINT_ATTRIBUTES_NONE) {
+        return;
+    }
+
+    if ((attributes->type == POINT_ATTRIBUTES_SCALAR && nValues != 1) || (attributes->type == POINT_ATTRIBUTES_RGB && nValues != 3)) {
+        printf("Line %lu has a different number of attributes than the first line of the file\n", i);
+        exit(-1);
+    }
+
+    if (attributes->type == POINT_ATTRIBUTES_SCALAR) {
+        attributes->scalars[i] = values[0];
+
+        if (i == 0 || values[0] < attributes->minScalar) {
+            attributes->minScalar = values[0];
+        }
+        if (i == 0 || values[0] > attributes->maxScalar) {
+            attributes->maxScalar = values[0];
+        }
+    }
+    else {
+        attributes->colors[i].r = values[0] / 255.f;
+        attributes->colors[i].g = values[1] / 255.f;
+        attributes->colors[i].b = values[2] / 255.f;
+        attributes->colors[i].a = 1.f;
+    }
+}
+
+
+Vector3f* readPointsFromFile(unsigned long* n, const char* fname, PointAttributes* attributes) {
     FILE* fpointer;
     fopen_s(&fpointer, fname, "r");
 
@@ -86,11 +171,27 @@ Vector3f* readPointsFromFile(unsigned long* n, const char* fname) {
             exit(-1);
         }
         else {
-            char vectorParseBuffer[50];
+            if (attributes != NULL) {
+                initPointAttributes(attributes, 0, lines);     // Files without any lines have no attributes
+            }
+
+            char vectorParseBuffer[128];
             fseek(fpointer, 0, SEEK_SET);   // Moves file cursor back to the start
             for (unsigned long i = 0; i < lines; i++) {
-                fgets(vectorParseBuffer, 50, fpointer);
+                fgets(vectorParseBuffer, 128, fpointer);
                 v[i] = strToVector3f(vectorParseBuffer, i);
+
+                if (attributes != NULL) {
+                    float values[4];
+                    unsigned nValues = strToAttributes(vectorParseBuffer, values, 4);
+
+                    // The first line decides which kind of attributes the whole file has
+                    if (i == 0) {
+                        initPointAttributes(attributes, nValues, lines);
+                    }
+
+                    storePointAttributes(attributes, i, values, nValues);
+                }
             }
 
             fclose(fpointer);
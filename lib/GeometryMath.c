@@ -20,15 +20,16 @@ Vector3f getPointsCenter(Vector3f points[], unsigned count) {
 
 
 
-SDL_FPoint map3dTo2d(
-    const Vector3f* pt,                 // Point to map
-    const Vector3f* cameraPos,          // Position of the camera in 3D space
-    const Vector3f* cameraTarget,       // Target point that the camera is looking at
-    const Vector3f* cameraUpDirection,  // Vector that indicates the 'up' direction
+CameraBasis makeCameraBasis(
+    const Vector3f* cameraPos,
+    const Vector3f* cameraTarget,
+    const Vector3f* cameraUpDirection,
     double y_fov_deg,
-    float originX, float originY,
     int screenWidth, int screenHeight)
 {
+    CameraBasis camera;
+    camera.position = *cameraPos;
+
     /*
     We calculate the vectors that tell us the direction in which the camera is pointing(i.e.positive axis' for all 3 sets of coordinates):
 
@@ -37,21 +38,29 @@ SDL_FPoint map3dTo2d(
         - Up vector       Indicates the positive vertical direction from the camera.
     */
     const Vector3f tempForward = subtract(cameraTarget, cameraPos);             // Intermediate step for calculating 'forward' vector
-    const Vector3f forward = createUnitaryVector(&tempForward);                 // unitary vector pointing towards cameraTarget
+    camera.forward = createUnitaryVector(&tempForward);                         // unitary vector pointing towards cameraTarget
     
-    const Vector3f tempRight = crossProduct(cameraUpDirection, &forward);       // Intermediate step for calculating 'right' vector
-    const Vector3f right = createUnitaryVector(&tempRight);     // Cross product of forward direction and up direction (i.e. perpendicular vector to both of these)
+    const Vector3f tempRight = crossProduct(cameraUpDirection, &camera.forward);    // Intermediate step for calculating 'right' vector
+    camera.right = createUnitaryVector(&tempRight);     // Cross product of forward direction and up direction (i.e. perpendicular vector to both of these)
 
-    const Vector3f up = crossProduct(&forward, &right);         // Same principle as with right vector. Doesn't need to be made unitary because both forward and right already are unitary vectors
+    camera.up = crossProduct(&camera.forward, &camera.right);   // Same principle as with right vector. Doesn't need to be made unitary because both forward and right already are unitary vectors
+
+    double y_fov_rad = y_fov_deg * TO_RAD_CONSTANT;
+    camera.f_y = screenHeight / tan(y_fov_rad);
+    camera.f_x = camera.f_y * ((double)screenWidth / (double)screenHeight);
+
+    return camera;
+}
 
 
-    Vector3f relativePoint = subtract(pt, cameraPos);    // Point relative to the camera's position
+SDL_FPoint map3dTo2dWithBasis(const Vector3f* pt, const CameraBasis* camera, float originX, float originY) {
+    Vector3f relativePoint = subtract(pt, &camera->position);    // Point relative to the camera's position
 
     // Point's coordinates in 3D, as 'seen' by the camera
     Vector3f coordsFromCamera = makeVector3f(
-        (float)dotProduct(&right, &relativePoint),
-        (float)dotProduct(&up, &relativePoint),
-        (float)dotProduct(&forward, &relativePoint)
+        (float)dotProduct(&camera->right, &relativePoint),
+        (float)dotProduct(&camera->up, &relativePoint),
+        (float)dotProduct(&camera->forward, &relativePoint)
     );
     /*
     From the lines above, we get that:
@@ -60,18 +69,28 @@ SDL_FPoint map3dTo2d(
         Z axis represents distance away from the camera
     */
 
-    double y_fov_rad = y_fov_deg * TO_RAD_CONSTANT;
-    double f_y = screenHeight / tan(y_fov_rad);
-    double f_x = f_y * ((double)screenWidth / (double)screenHeight);
-
     SDL_FPoint out;
-    out.x = (float)(coordsFromCamera.x * f_x / coordsFromCamera.z + originX);
-    out.y = (float)(-(originY + coordsFromCamera.y * f_y / coordsFromCamera.z));
+    out.x = (float)(coordsFromCamera.x * camera->f_x / coordsFromCamera.z + originX);
+    out.y = (float)(-(originY + coordsFromCamera.y * camera->f_y / coordsFromCamera.z));
 
     return out;
 }
 
 
+SDL_FPoint map3dTo2d(
+    const Vector3f* pt,                 // Point to map
+    const Vector3f* cameraPos,          // Position of the camera in 3D space
+    const Vector3f* cameraTarget,       // Target point that the camera is looking at
+    const Vector3f* cameraUpDirection,  // Vector that indicates the 'up' direction
+    double y_fov_deg,
+    float originX, float originY,
+    int screenWidth, int screenHeight)
+{
+    const CameraBasis camera = makeCameraBasis(cameraPos, cameraTarget, cameraUpDirection, y_fov_deg, screenWidth, screenHeight);
+    return map3dTo2dWithBasis(pt, &camera, originX, originY);
+}
+
+
 bool rotateVector3f(Vector3f* p, const Vector3f* origin, double x_deg, double y_deg, double z_deg) {
     // https://en.wikipedia.org/wiki/Rotation_matrix#In_three_dimensions
 
@@ -141,4 +160,60 @@ bool rotateVector3f(Vector3f* p, const Vector3f* origin, double x_deg, double y_
     *p = add(p, origin);
 
     return true;
+}
+
+
+Vector3f rotateWithBasis(const Vector3f* p, const Vector3f basis[3], const Vector3f* midPoint) {
+    Vector3f rel = subtract(p, midPoint);
+
+    return makeVector3f(
+        midPoint->x + basis[0].x * rel.x + basis[1].x * rel.y + basis[2].x * rel.z,
+        midPoint->y + basis[0].y * rel.x + basis[1].y * rel.y + basis[2].y * rel.z,
+        midPoint->z + basis[0].z * rel.x + basis[1].z * rel.y + basis[2].z * rel.z
+    );
+}
+
+
+void applyScreenTransform(const SDL_FPoint projected[], SDL_FPoint out[], unsigned long count, float scale, float originX, float originY) {
+    // Same origin convention as map3dTo2d (i.e. the Y origin is negated)
+    for (unsigned long i = 0; i < count; i++) {
+        out[i].x = projected[i].x * scale + originX;
+        out[i].y = projected[i].y * scale - originY;
+    }
+}
+
+
+void translatePoints(SDL_FPoint points[], unsigned long count, float dx, float dy) {
+    for (unsigned long i = 0; i < count; i++) {
+        points[i].x += dx;
+        points[i].y += dy;
+    }
+}
+
+
+bool isZoomScalable(float boundingRadius, double oldDistance, double newDistance, double y_fov_deg, int screenWidth, int screenHeight, float tolerancePx) {
+    /*
+    Moving the camera along its forward vector keeps the right and up vectors the same, so a point (x, y, z) seen from the camera
+    only changes its depth: z' = z + delta. Its exact 2D position f * x / z' is approximated by scaling f * x / z by oldDistance / newDistance,
+    which is exact for the points as far away as the target. For the rest, the error is:
+
+        f * |x| * |delta| * |z - oldDistance| / (z' * newDistance * z)
+
+    With |x| and |z - oldDistance| at most boundingRadius, and z, z' at least (distance - boundingRadius), this gives an upper bound of the error
+    */
+    const double r = boundingRadius;
+
+    if (oldDistance - r <= 0.0 || newDistance - r <= 0.0) {
+        return false;   // Some points could be at or behind the camera
+    }
+
+    double y_fov_rad = y_fov_deg * TO_RAD_CONSTANT;
+    double f_y = screenHeight / tan(y_fov_rad);
+    double f_x = f_y * ((double)screenWidth / (double)screenHeight);
+    double f = (f_x > f_y) ? f_x : f_y;
+
+    double delta = fabs(newDistance - oldDistance);
+    double maxError = f * r * delta * r / ((newDistance - r) * newDistance * (oldDistance - r));
+
+    return maxError <= tolerancePx;
 }
\ No newline at end of file
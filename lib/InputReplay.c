@@ -0,0 +1,181 @@
+#pragma once
+#include "../include/InputReplay.h"
+#include <string.h>
+
+
+bool openInputRecording(InputLog* log, const char* fname, const SDL_FPoint* startMousePos, int windowWidth, int windowHeight) {
+    memset(log, 0, sizeof(InputLog));
+    fopen_s(&log->file, fname, "w");
+
+    if (log->file == NULL) {
+        perror("Unable to create recording file\n");
+        return false;
+    }
+
+    fprintf(log->file, "%s %d %d %.9g %.9g\n", RECORDING_HEADER, windowWidth, windowHeight, startMousePos->x, startMousePos->y);
+    log->windowWidth = windowWidth;
+    log->windowHeight = windowHeight;
+    log->isRecording = true;
+    return true;
+}
+
+
+bool openInputReplay(InputLog* log, const char* fname, SDL_FPoint* startMousePos) {
+    memset(log, 0, sizeof(InputLog));
+    fopen_s(&log->file, fname, "r");
+
+    if (log->file == NULL) {
+        perror("Unable to read recording file\n");
+        return false;
+    }
+
+    char header[128];
+    const size_t headerLength = strlen(RECORDING_HEADER);
+    if (fgets(header, 128, log->file) == NULL || strncmp(header, RECORDING_HEADER, headerLength) != 0
+        || sscanf(header + headerLength, "%d %d %f %f", &log->windowWidth, &log->windowHeight, &startMousePos->x, &startMousePos->y) != 4
+        || log->windowWidth <= 0 || log->windowHeight <= 0) {
+        printf("'%s' is not an input recording\n", fname);
+        fclose(log->file);
+        log->file = NULL;
+        return false;
+    }
+
+    log->isReplaying = true;
+    return true;
+}
+
+
+void recordFrameInput(InputLog* log, const FrameInput* input, const CameraState* state) {
+    // One line per frame: input first, then the camera state it resulted in
+    fprintf(log->file, "%llu %llu %u %u %.9g %.9g %d %.9g %.9g %.9g %.9g %.9g %.9g\n",
+        (unsigned long long)log->frame, (unsigned long long)input->ticks,
+        input->heldKeys, input->pressedKeys,
+        input->mousePos.x, input->mousePos.y, input->mouseDown ? 1 : 0, input->wheelY,
+        state->rotationAngles.x, state->rotationAngles.y, state->zCamValue, state->originXY.x, state->originXY.y
+    );
+    log->frame++;
+}
+
+
+bool readFrameInput(InputLog* log, FrameInput* input, CameraState* expected) {
+    char line[256];
+    if (fgets(line, 256, log->file) == NULL) {
+        return false;
+    }
+
+    unsigned long long frame, ticks;
+    int mouseDown;
+    int nRead = sscanf(line, "%llu %llu %u %u %f %f %d %f %f %f %f %f %f",
+        &frame, &ticks, &input->heldKeys, &input->pressedKeys,
+        &input->mousePos.x, &input->mousePos.y, &mouseDown, &input->wheelY,
+        &expected->rotationAngles.x, &expected->rotationAngles.y, &expected->zCamValue, &expected->originXY.x, &expected->originXY.y
+    );
+
+    // Every frame is written as a whole line with consecutive numbers, so anything else means the file was cut or changed
+    if (nRead != 13 || frame != log->frame || strchr(line, '\n') == NULL) {
+        printf("Invalid frame in line %llu of the recording\n", (unsigned long long)log->frame + 2);
+        log->isCorrupt = true;
+        return false;
+    }
+
+    input->ticks = (Uint64)ticks;
+    input->mouseDown = mouseDown != 0;
+    expected->rotationAngles.z = 0.f;
+
+    log->frame++;
+    return true;
+}
+
+
+void checkReplayedFrame(InputLog* log, const CameraState* state, const CameraState* expected, double frameMs) {
+    // Values are compared with the precision they were written with
+    if (fabs(state->rotationAngles.x - expected->rotationAngles.x) > 1e-4 || fabs(state->rotationAngles.y - expected->rotationAngles.y) > 1e-4
+        || fabs(state->zCamValue - expected->zCamValue) > 1e-4
+        || fabs(state->originXY.x - expected->originXY.x) > 1e-3 || fabs(state->originXY.y - expected->originXY.y) > 1e-3) {
+        log->mismatches++;
+    }
+
+    if (log->frame > log->capacity) {
+        unsigned long newCapacity = (log->capacity == 0) ? 1024 : log->capacity * 2;
+        double* newTimes = (double*)SDL_realloc(log->frameTimes, newCapacity * sizeof(double));
+        if (newTimes == NULL) {
+            return;     // Timings are lost, but the replay can go on
+        }
+        log->frameTimes = newTimes;
+        log->capacity = newCapacity;
+    }
+    log->frameTimes[log->frame - 1] = frameMs;
+}
+
+
+Uint64 hashBytes(Uint64 hash, const void* data, size_t size) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;    // FNV prime
+    }
+    return hash;
+}
+
+
+/*
+Comparison function for qsort, orders doubles from smallest to biggest
+*/
+static int compareDoubles(const void* a, const void* b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+
+bool printReplayReport(const InputLog* log, Uint64 checksum) {
+    unsigned long n = (log->frame < log->capacity) ? (unsigned long)log->frame : log->capacity;
+
+    if (log->timingsFname != NULL) {
+        FILE* timingsFile;
+        fopen_s(&timingsFile, log->timingsFname, "w");
+        if (timingsFile == NULL) {
+            perror("Unable to create timings file\n");
+        }
+        else {
+            for (unsigned long i = 0; i < n; i++) {
+                fprintf(timingsFile, "%.4f\n", log->frameTimes[i]);
+            }
+            fclose(timingsFile);
+        }
+    }
+
+    double total = 0.0;
+    double* sorted = (double*)SDL_malloc((n > 0 ? n : 1) * sizeof(double));
+    if (sorted == NULL) {
+        perror("Unable to allocate memory for the replay report\n");
+        return false;
+    }
+    for (unsigned long i = 0; i < n; i++) {
+        sorted[i] = log->frameTimes[i];
+        total += log->frameTimes[i];
+    }
+    qsort(sorted, n, sizeof(double), compareDoubles);
+
+    printf("Replayed %lu frames (%lu with a different camera state than the recording)\n", n, log->mismatches);
+    if (n > 0) {
+        printf("Frame time (ms): mean %.3f, p50 %.3f, p95 %.3f, p99 %.3f, max %.3f\n",
+            total / n, sorted[n / 2], sorted[(n * 95) / 100], sorted[(n * 99) / 100], sorted[n - 1]);
+    }
+    printf("Final state checksum: %016llx\n", (unsigned long long)checksum);
+    if (log->isCorrupt) {
+        printf("The recording is truncated or corrupt, the replay did not reach its end\n");
+    }
+
+    SDL_free(sorted);
+    return !log->isCorrupt && log->mismatches == 0;
+}
+
+
+void closeInputLog(InputLog* log) {
+    if (log->file != NULL) {
+        fclose(log->file);
+    }
+    SDL_free(log->frameTimes);
+    memset(log, 0, sizeof(InputLog));
+}
@@ -0,0 +1,286 @@
+#pragma once
+#include "../include/PointRendering.h"
+
+
+// Colors at evenly spaced positions of the colormap (approximation of 'viridis'), the rest are interpolated linearly
+static const SDL_FColor colormapStops[] = {
+    { 0.267f, 0.004f, 0.329f, 1.f },
+    { 0.231f, 0.322f, 0.545f, 1.f },
+    { 0.129f, 0.569f, 0.549f, 1.f },
+    { 0.369f, 0.788f, 0.384f, 1.f },
+    { 0.992f, 0.906f, 0.145f, 1.f }
+};
+static const unsigned nColormapStops = sizeof(colormapStops) / sizeof(colormapStops[0]);
+
+
+SDL_FColor colormapScalar(float value, float minValue, float maxValue) {
+    // Value normalized to the [0, 1] range (if all the values are the same, the middle of the colormap is used)
+    float t = 0.5f;
+    if (maxValue > minValue) {
+        t = (value - minValue) / (maxValue - minValue);
+    }
+
+    if (t <= 0.f) {
+        return colormapStops[0];
+    }
+    if (t >= 1.f) {
+        return colormapStops[nColormapStops - 1];
+    }
+
+    // Finding the two stops between which the value lies
+    float pos = t * (nColormapStops - 1);
+    unsigned lower = (unsigned)pos;
+    float frac = pos - lower;
+
+    const SDL_FColor* a = &colormapStops[lower];
+    const SDL_FColor* b = &colormapStops[lower + 1];
+
+    SDL_FColor out;
+    out.r = a->r + (b->r - a->r) * frac;
+    out.g = a->g + (b->g - a->g) * frac;
+    out.b = a->b + (b->b - a->b) * frac;
+    out.a = 1.f;
+
+    return out;
+}
+
+
+void applyColormap(const float scalars[], SDL_FColor colors[], unsigned long count, float minValue, float maxValue) {
+    for (unsigned long i = 0; i < count; i++) {
+        colors[i] = colormapScalar(scalars[i], minValue, maxValue);
+    }
+}
+
+
+bool createPointBatch(PointBatch* batch, const SDL_FColor colors[], unsigned long nPoints) {
+    batch->colors = colors;
+    batch->capacity = nPoints;
+    batch->nPoints = nPoints;
+    batch->stride = 1;
+    batch->isValid = false;
+    batch->vertices = (SDL_Vertex*)SDL_calloc(nPoints * 4, sizeof(SDL_Vertex));
+    batch->indices = (int*)SDL_calloc(nPoints * 6, sizeof(int));
+
+    if (batch->vertices == NULL || batch->indices == NULL) {
+        destroyPointBatch(batch);
+        return false;
+    }
+
+    for (unsigned long i = 0; i < nPoints; i++) {
+        // Indices are the same in every frame, and colors only change along with the stride, so they are set here
+        for (unsigned corner = 0; corner < 4; corner++) {
+            batch->vertices[i * 4 + corner].color = colors[i];
+        }
+
+        /*
+        Corners are stored as:
+            0 - 1
+            | / |
+            2 - 3
+        */
+        int first = (int)(i * 4);
+        batch->indices[i * 6 + 0] = first + 0;
+        batch->indices[i * 6 + 1] = first + 1;
+        batch->indices[i * 6 + 2] = first + 2;
+        batch->indices[i * 6 + 3] = first + 1;
+        batch->indices[i * 6 + 4] = first + 3;
+        batch->indices[i * 6 + 5] = first + 2;
+    }
+
+    return true;
+}
+
+
+void updatePointBatch(PointBatch* batch, const SDL_FPoint points[], unsigned long nPoints, unsigned long stride, float pointSize) {
+    const float half = pointSize / 2.f;
+
+    // Vertex i now belongs to point i * stride, so it takes its color
+    if (stride != batch->stride) {
+        for (unsigned long i = 0; i < nPoints && i * stride < batch->capacity; i++) {
+            for (unsigned corner = 0; corner < 4; corner++) {
+                batch->vertices[i * 4 + corner].color = batch->colors[i * stride];
+            }
+        }
+        batch->stride = stride;
+    }
+    batch->nPoints = SDL_min(nPoints, batch->capacity);
+
+    for (unsigned long i = 0; i < batch->nPoints; i++) {
+        SDL_Vertex* v = &batch->vertices[i * 4];
+
+        v[0].position.x = points[i].x - half;   v[0].position.y = points[i].y - half;
+        v[1].position.x = points[i].x + half;   v[1].position.y = points[i].y - half;
+        v[2].position.x = points[i].x - half;   v[2].position.y = points[i].y + half;
+        v[3].position.x = points[i].x + half;   v[3].position.y = points[i].y + half;
+    }
+
+    batch->isValid = true;
+}
+
+
+void translatePointBatch(PointBatch* batch, float dx, float dy) {
+    for (unsigned long i = 0; i < batch->nPoints * 4; i++) {
+        batch->vertices[i].position.x += dx;
+        batch->vertices[i].position.y += dy;
+    }
+}
+
+
+void drawPointBatch(SDL_Renderer* r, const PointBatch* batch) {
+    if (batch->vertices == NULL || batch->nPoints == 0) {
+        return;
+    }
+
+    SDL_RenderGeometry(r, NULL, batch->vertices, (int)(batch->nPoints * 4), batch->indices, (int)(batch->nPoints * 6));
+}
+
+
+void destroyPointBatch(PointBatch* batch) {
+    SDL_free(batch->vertices);
+    SDL_free(batch->indices);
+    batch->vertices = NULL;
+    batch->indices = NULL;
+    batch->colors = NULL;
+    batch->capacity = 0;
+    batch->nPoints = 0;
+    batch->isValid = false;
+}
+
+
+bool createSimplifiedPolyline(SimplifiedPolyline* polyline, unsigned long capacity) {
+    polyline->nPoints = 0;
+    polyline->capacity = capacity;
+    polyline->isValid = false;
+    polyline->points = (SDL_FPoint*)SDL_calloc(capacity, sizeof(SDL_FPoint));
+    polyline->keep = (bool*)SDL_calloc(capacity, sizeof(bool));
+    polyline->stack = (unsigned long*)SDL_calloc(capacity * 2, sizeof(unsigned long));
+
+    if (polyline->points == NULL || polyline->keep == NULL || polyline->stack == NULL) {
+        destroySimplifiedPolyline(polyline);
+        return false;
+    }
+
+    return true;
+}
+
+
+/*
+Returns the squared distance between point p and the segment that goes from a to b
+*/
+static float squaredSegmentDistance(const SDL_FPoint* p, const SDL_FPoint* a, const SDL_FPoint* b) {
+    float dx = b->x - a->x;
+    float dy = b->y - a->y;
+    float lengthSq = dx * dx + dy * dy;
+
+    float t = 0.f;
+    if (lengthSq > 0.f) {
+        t = ((p->x - a->x) * dx + (p->y - a->y) * dy) / lengthSq;
+        t = (t < 0.f) ? 0.f : ((t > 1.f) ? 1.f : t);
+    }
+
+    float ex = p->x - (a->x + t * dx);
+    float ey = p->y - (a->y + t * dy);
+    return ex * ex + ey * ey;
+}
+
+
+void simplifyPolyline(SimplifiedPolyline* polyline, const SDL_FPoint points[], unsigned long count, float tolerancePx) {
+    const float toleranceSq = tolerancePx * tolerancePx;
+    SDL_FPoint* out = polyline->points;
+
+    if (count > polyline->capacity) {
+        count = polyline->capacity;
+    }
+    if (count < 3) {
+        for (unsigned long i = 0; i < count; i++) {
+            out[i] = points[i];
+        }
+        polyline->nPoints = count;
+        polyline->isValid = true;
+        return;
+    }
+
+    /*
+    First pass: merging runs of sub-pixel segments.
+    A vertex is only kept if it is further away than the tolerance from the last vertex kept (the last one is always kept)
+    */
+    unsigned long n = 1;
+    out[0] = points[0];
+    for (unsigned long i = 1; i < count - 1; i++) {
+        float dx = points[i].x - out[n - 1].x;
+        float dy = points[i].y - out[n - 1].y;
+        if (dx * dx + dy * dy > toleranceSq) {
+            out[n] = points[i];
+            n++;
+        }
+    }
+    out[n] = points[count - 1];
+    n++;
+
+    /*
+    Second pass: Douglas-Peucker over the merged polyline.
+    An explicit stack is used instead of recursion, as the polylines can have millions of vertices
+    */
+    for (unsigned long i = 0; i < n; i++) {
+        polyline->keep[i] = false;
+    }
+    polyline->keep[0] = polyline->keep[n - 1] = true;
+
+    unsigned long stackSize = 0;
+    polyline->stack[stackSize++] = 0;
+    polyline->stack[stackSize++] = n - 1;
+
+    while (stackSize > 0) {
+        unsigned long last = polyline->stack[--stackSize];
+        unsigned long first = polyline->stack[--stackSize];
+
+        // Finding the vertex furthest away from the segment that joins both ends
+        float maxDistSq = 0.f;
+        unsigned long furthest = first;
+        for (unsigned long i = first + 1; i < last; i++) {
+            float distSq = squaredSegmentDistance(&out[i], &out[first], &out[last]);
+            if (distSq > maxDistSq) {
+                maxDistSq = distSq;
+                furthest = i;
+            }
+        }
+
+        // If it deviates too much, it is kept and both halves are simplified separately
+        if (maxDistSq > toleranceSq) {
+            polyline->keep[furthest] = true;
+
+            if (furthest - first > 1) {
+                polyline->stack[stackSize++] = first;
+                polyline->stack[stackSize++] = furthest;
+            }
+            if (last - furthest > 1) {
+                polyline->stack[stackSize++] = furthest;
+                polyline->stack[stackSize++] = last;
+            }
+        }
+    }
+
+    // Moving the surviving vertices to the start of the array (in the same order)
+    unsigned long kept = 0;
+    for (unsigned long i = 0; i < n; i++) {
+        if (polyline->keep[i]) {
+            out[kept] = out[i];
+            kept++;
+        }
+    }
+
+    polyline->nPoints = kept;
+    polyline->isValid = true;
+}
+
+
+void destroySimplifiedPolyline(SimplifiedPolyline* polyline) {
+    SDL_free(polyline->points);
+    SDL_free(polyline->keep);
+    SDL_free(polyline->stack);
+    polyline->points = NULL;
+    polyline->keep = NULL;
+    polyline->stack = NULL;
+    polyline->nPoints = polyline->capacity = 0;
+    polyline->isValid = false;
+}
@@ -0,0 +1,136 @@
+#pragma once
+#include "../include/RenderScaling.h"
+
+
+/*
+Creates the texture for the current internal resolution (or frees it when drawing at full resolution). Returns false if it could not be created
+*/
+static bool createScaledTarget(RenderScaler* scaler, SDL_Renderer* r) {
+    if (scaler->target != NULL) {
+        SDL_DestroyTexture(scaler->target);
+        scaler->target = NULL;
+    }
+
+    if (scaler->renderScale >= 1.f) {
+        return true;
+    }
+
+    int width = (int)(scaler->windowWidth * scaler->renderScale);
+    int height = (int)(scaler->windowHeight * scaler->renderScale);
+    scaler->target = SDL_CreateTexture(r, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, (width > 0) ? width : 1, (height > 0) ? height : 1);
+
+    if (scaler->target == NULL) {
+        SDL_Log("Couldn't create texture for the internal resolution: %s", SDL_GetError());
+        scaler->renderScale = 1.f;      // Falling back to drawing directly to the window
+        return false;
+    }
+
+    SDL_SetTextureScaleMode(scaler->target, SDL_SCALEMODE_LINEAR);
+    return true;
+}
+
+
+bool resizeRenderScaler(RenderScaler* scaler, SDL_Renderer* r, int windowWidth, int windowHeight) {
+    scaler->windowWidth = windowWidth;
+    scaler->windowHeight = windowHeight;
+    return createScaledTarget(scaler, r);
+}
+
+
+bool fixRenderScale(RenderScaler* scaler, SDL_Renderer* r, float renderScale) {
+    scaler->renderScale = SDL_min(renderScale, 1.f);
+    scaler->isScaleFixed = true;
+    return createScaledTarget(scaler, r);
+}
+
+
+void beginScaledFrame(const RenderScaler* scaler, SDL_Renderer* r) {
+    if (scaler->target == NULL) {
+        return;
+    }
+
+    // The texture size was rounded, so the scale is calculated from it to make the window fit exactly
+    float textureWidth, textureHeight;
+    SDL_GetTextureSize(scaler->target, &textureWidth, &textureHeight);
+
+    SDL_SetRenderTarget(r, scaler->target);
+    SDL_SetRenderScale(r, textureWidth / scaler->windowWidth, textureHeight / scaler->windowHeight);
+}
+
+
+void endScaledFrame(const RenderScaler* scaler, SDL_Renderer* r) {
+    if (scaler->target == NULL) {
+        return;
+    }
+
+    SDL_SetRenderTarget(r, NULL);
+    SDL_RenderTexture(r, scaler->target, NULL, NULL);
+}
+
+
+void updateRenderScaler(RenderScaler* scaler, SDL_Renderer* r, double frameMs, bool isIdle, Uint64 nPoints) {
+    // The average smooths out single slow frames, so that the quality only changes when frames are slow consistently
+    scaler->frameTimeMs = (scaler->frameTimeMs == 0.0) ? frameMs : scaler->frameTimeMs + (frameMs - scaler->frameTimeMs) * FRAME_TIME_SMOOTHING;
+    scaler->framesSinceChange++;
+    scaler->idleFrames = isIdle ? scaler->idleFrames + 1 : 0;
+
+    // A fixed internal resolution is not a loss of quality that can be undone
+    const bool isDegraded = (!scaler->isScaleFixed && scaler->renderScale < 1.f) || scaler->pointBudget < nPoints;
+
+    // When nothing moves for a while, the full quality is restored at once (the frame time doesn't matter while the view doesn't change)
+    if (scaler->idleFrames >= IDLE_FRAMES_TO_RESTORE) {
+        if (isDegraded) {
+            scaler->pointBudget = SDL_MAX_UINT64;
+            scaler->framesSinceChange = 0;
+            if (!scaler->isScaleFixed) {
+                scaler->renderScale = 1.f;
+                createScaledTarget(scaler, r);
+            }
+        }
+        return;
+    }
+
+    if (isIdle || scaler->framesSinceChange < ADAPT_INTERVAL_FRAMES) {
+        return;
+    }
+
+    if (scaler->frameTimeMs > scaler->targetFrameMs) {
+        // Too slow: the resolution is lowered first, and then the number of points
+        if (!scaler->isScaleFixed && scaler->renderScale > MIN_RENDER_SCALE) {
+            scaler->renderScale = SDL_max(scaler->renderScale - RENDER_SCALE_STEP, MIN_RENDER_SCALE);
+            createScaledTarget(scaler, r);
+        }
+        else {
+            Uint64 budget = SDL_min(scaler->pointBudget, nPoints);
+            scaler->pointBudget = SDL_max(budget / 4 * 3, MIN_POINT_BUDGET);
+        }
+        scaler->framesSinceChange = 0;
+    }
+    else if (isDegraded && scaler->frameTimeMs < scaler->targetFrameMs * RESTORE_FRAME_TIME_FRACTION) {
+        // Fast enough to afford more quality: the opposite order is used to restore it
+        if (scaler->pointBudget < nPoints) {
+            scaler->pointBudget = (scaler->pointBudget / 3 * 4 >= nPoints) ? SDL_MAX_UINT64 : scaler->pointBudget / 3 * 4;
+        }
+        else {
+            scaler->renderScale = SDL_min(scaler->renderScale + RENDER_SCALE_STEP, 1.f);
+            createScaledTarget(scaler, r);
+        }
+        scaler->framesSinceChange = 0;
+    }
+}
+
+
+Uint64 budgetStride(const RenderScaler* scaler, Uint64 count) {
+    if (count <= scaler->pointBudget) {
+        return 1;
+    }
+    return (count + scaler->pointBudget - 1) / scaler->pointBudget;     // Rounded up so that the budget is never exceeded
+}
+
+
+void destroyRenderScaler(RenderScaler* scaler) {
+    if (scaler->target != NULL) {
+        SDL_DestroyTexture(scaler->target);
+        scaler->target = NULL;
+    }
+}
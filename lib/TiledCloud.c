@@ -0,0 +1,354 @@
+#pragma once
+#include "../include/TiledCloud.h"
+#include "../include/GeometryMath.h"
+#include <stdio.h>
+#include <string.h>
+
+#define TILE_BYTES_PER_POINT (sizeof(Vector3f) + sizeof(SDL_FPoint))     // Memory used by every point of a resident tile (its 3D and 2D positions)
+
+
+bool isTiledFile(const char* fname) {
+    SDL_IOStream* file = SDL_IOFromFile(fname, "rb");
+    if (file == NULL) {
+        return false;
+    }
+
+    char magic[4];
+    bool isTiled = SDL_ReadIO(file, magic, 4) == 4 && memcmp(magic, TILED_FILE_MAGIC, 4) == 0;
+
+    SDL_CloseIO(file);
+    return isTiled;
+}
+
+
+/*
+Function run by the reader thread: waits for tiles to be requested and reads their points from the file
+*/
+static int readTiles(void* data) {
+    TileCache* cache = (TileCache*)data;
+
+    while (true) {
+        SDL_LockMutex(cache->lock);
+        while (cache->nRequests == 0 && !cache->quit) {
+            SDL_WaitCondition(cache->hasRequests, cache->lock);
+        }
+        if (cache->quit) {
+            SDL_UnlockMutex(cache->lock);
+            return 0;
+        }
+
+        Uint32 index = cache->requests[cache->requestsStart];
+        cache->requestsStart = (cache->requestsStart + 1) % cache->header.nTiles;
+        cache->nRequests--;
+        const TileIndexEntry entry = cache->tiles[index].entry;
+        SDL_UnlockMutex(cache->lock);
+
+        // The memory was already accounted for when the tile was requested, so it can be allocated freely here
+        size_t bytes = (size_t)entry.nPoints * sizeof(Vector3f);
+        Vector3f* points = (Vector3f*)SDL_malloc(bytes);
+        SDL_FPoint* projected = (SDL_FPoint*)SDL_malloc((size_t)entry.nPoints * sizeof(SDL_FPoint));
+
+        bool success = points != NULL && projected != NULL
+            && SDL_SeekIO(cache->file, (Sint64)entry.offset, SDL_IO_SEEK_SET) >= 0
+            && SDL_ReadIO(cache->file, points, bytes) == bytes;
+
+        SDL_LockMutex(cache->lock);
+        if (success) {
+            cache->tiles[index].points = points;
+            cache->tiles[index].projected = projected;
+            cache->tiles[index].projectedVersion = 0;
+            cache->tiles[index].state = TILE_RESIDENT;
+            cache->nResidentTiles++;
+        }
+        else {
+            // The tile is not requested again, since reading it would most likely fail every time
+            printf("Unable to read tile %u from the tiled file\n", index);
+            SDL_free(points);
+            SDL_free(projected);
+            cache->tiles[index].state = TILE_FAILED;
+            cache->residentBytes -= (Uint64)entry.nPoints * TILE_BYTES_PER_POINT;
+        }
+        SDL_UnlockMutex(cache->lock);
+    }
+}
+
+
+TileCache* openTileCache(const char* fname, Uint64 maxResidentBytes) {
+    TileCache* cache = (TileCache*)SDL_calloc(1, sizeof(TileCache));
+    if (cache == NULL) {
+        perror("Unable to allocate memory for the tile cache\n");
+        return NULL;
+    }
+    cache->maxResidentBytes = maxResidentBytes;
+
+    cache->file = SDL_IOFromFile(fname, "rb");
+    if (cache->file == NULL
+        || SDL_ReadIO(cache->file, &cache->header, sizeof(TiledFileHeader)) != sizeof(TiledFileHeader)
+        || memcmp(cache->header.magic, TILED_FILE_MAGIC, 4) != 0) {
+        printf("Unable to read the header of tiled file '%s'\n", fname);
+        closeTileCache(cache);
+        return NULL;
+    }
+
+    cache->tiles = (Tile*)SDL_calloc(cache->header.nTiles, sizeof(Tile));
+    cache->requests = (Uint32*)SDL_calloc(cache->header.nTiles, sizeof(Uint32));
+    if (cache->tiles == NULL || cache->requests == NULL) {
+        perror("Unable to allocate memory for the tile index\n");
+        closeTileCache(cache);
+        return NULL;
+    }
+
+    // Reading the index (the points themselves are only read when needed)
+    for (Uint32 i = 0; i < cache->header.nTiles; i++) {
+        if (SDL_ReadIO(cache->file, &cache->tiles[i].entry, sizeof(TileIndexEntry)) != sizeof(TileIndexEntry)) {
+            printf("Unable to read the index of tiled file '%s'\n", fname);
+            closeTileCache(cache);
+            return NULL;
+        }
+
+        cache->tiles[i].state = TILE_UNLOADED;
+    }
+    cache->projectionVersion = 1;   // Tiles start with version 0, so they are mapped to 2D the first time they are drawn
+
+    cache->lock = SDL_CreateMutex();
+    cache->hasRequests = SDL_CreateCondition();
+    if (cache->lock == NULL || cache->hasRequests == NULL) {
+        perror("Unable to create the tile cache\n");
+        closeTileCache(cache);
+        return NULL;
+    }
+
+    cache->reader = SDL_CreateThread(readTiles, "TileReader", cache);
+    if (cache->reader == NULL) {
+        SDL_Log("Couldn't create the tile reader thread: %s", SDL_GetError());
+        closeTileCache(cache);
+        return NULL;
+    }
+
+    printf("Opened tiled file '%s' with %llu points in %u tiles\n", fname, (unsigned long long)cache->header.nPoints, cache->header.nTiles);
+    return cache;
+}
+
+
+/*
+Returns true if both vectors are exactly the same
+*/
+static bool isSameVector3f(const Vector3f* a, const Vector3f* b) {
+    return a->x == b->x && a->y == b->y && a->z == b->z;
+}
+
+
+/*
+Returns true if any part of the bounding box of the tile can be seen by the camera.
+The box is treated as the sphere that contains it, so some tiles that are barely out of the screen count as visible
+*/
+static bool isTileVisible(const TileIndexEntry* entry, const TileView* view, const CameraBasis* camera) {
+    Vector3f center = makeVector3f(
+        (entry->minCorner.x + entry->maxCorner.x) / 2.f,
+        (entry->minCorner.y + entry->maxCorner.y) / 2.f,
+        (entry->minCorner.z + entry->maxCorner.z) / 2.f
+    );
+    Vector3f halfDiagonal = subtract(&entry->maxCorner, &center);
+    float radius = (float)sqrt(dotProduct(&halfDiagonal, &halfDiagonal));
+
+    center = rotateWithBasis(&center, view->rotationBasis, view->midPoint);
+
+    // Distance from the camera to the center of the tile along the direction in which the camera looks
+    const Vector3f relativeCenter = subtract(&center, &camera->position);
+    float depth = (float)dotProduct(&camera->forward, &relativeCenter);
+
+    if (depth + radius <= 0.f) {
+        return false;       // Completely behind the camera
+    }
+    if (depth - radius <= 0.f) {
+        return true;        // The camera is inside (or right next to) the tile
+    }
+
+    // Checking if the projection of the sphere overlaps the screen
+    SDL_FPoint projected = map3dTo2dWithBasis(&center, camera, view->originX, view->originY);
+    float radiusPx = (float)(radius * SDL_max(camera->f_x, camera->f_y) / (depth - radius));
+
+    return projected.x + radiusPx >= 0.f && projected.x - radiusPx <= view->screenWidth
+        && projected.y + radiusPx >= 0.f && projected.y - radiusPx <= view->screenHeight;
+}
+
+
+/*
+Frees the least recently used resident tile that is not visible in this frame. Returns false if there was none.
+MUST BE CALLED WITH THE LOCK OF THE CACHE HELD
+*/
+static bool evictLeastRecentlyUsed(TileCache* cache) {
+    Tile* oldest = NULL;
+    for (Uint32 i = 0; i < cache->header.nTiles; i++) {
+        Tile* t = &cache->tiles[i];
+        if (t->state == TILE_RESIDENT && !t->isVisible && (oldest == NULL || t->lastUsedFrame < oldest->lastUsedFrame)) {
+            oldest = t;
+        }
+    }
+
+    if (oldest == NULL) {
+        return false;
+    }
+
+    SDL_free(oldest->points);
+    SDL_free(oldest->projected);
+    oldest->points = NULL;
+    oldest->projected = NULL;
+    oldest->state = TILE_UNLOADED;
+    cache->residentBytes -= (Uint64)oldest->entry.nPoints * TILE_BYTES_PER_POINT;
+    cache->nResidentTiles--;
+    return true;
+}
+
+
+/*
+Returns true if the points of the tiles would be mapped to the same 2D positions as the last time they were mapped (except for the origin)
+*/
+static bool isSameProjection(const TileCache* cache, const CameraBasis* camera, const TileView* view) {
+    const CameraBasis* last = &cache->projectionCamera;
+    bool isSameCamera = isSameVector3f(&last->position, &camera->position) && isSameVector3f(&last->forward, &camera->forward)
+        && isSameVector3f(&last->right, &camera->right) && isSameVector3f(&last->up, &camera->up)
+        && last->f_x == camera->f_x && last->f_y == camera->f_y;
+
+    return isSameCamera
+        && isSameVector3f(&cache->projectionRotation[0], &view->rotationBasis[0])
+        && isSameVector3f(&cache->projectionRotation[1], &view->rotationBasis[1])
+        && isSameVector3f(&cache->projectionRotation[2], &view->rotationBasis[2]);
+}
+
+
+Uint64 drawTileCache(TileCache* cache, SDL_Renderer* r, const TileView* view, Uint64 pointBudget) {
+    cache->frame++;
+
+    // The camera is the same for every point, so it is only calculated once per frame
+    const CameraBasis camera = makeCameraBasis(view->cameraPos, view->cameraTarget, view->cameraUp, FOV_Y_DEG, view->screenWidth, view->screenHeight);
+
+    // If the view changed, the 2D points of every tile have to be mapped again
+    if (!isSameProjection(cache, &camera, view)) {
+        cache->projectionCamera = camera;
+        for (unsigned i = 0; i < 3; i++) {
+            cache->projectionRotation[i] = view->rotationBasis[i];
+        }
+        cache->projectionVersion++;
+    }
+
+    for (Uint32 i = 0; i < cache->header.nTiles; i++) {
+        cache->tiles[i].isVisible = isTileVisible(&cache->tiles[i].entry, view, &camera);
+        if (cache->tiles[i].isVisible) {
+            cache->tiles[i].lastUsedFrame = cache->frame;
+        }
+    }
+
+    // Requesting the visible tiles that are not in memory, as long as they fit in the memory limit
+    SDL_LockMutex(cache->lock);
+    unsigned requestsThisFrame = 0;
+    for (Uint32 i = 0; i < cache->header.nTiles && requestsThisFrame < MAX_TILE_REQUESTS_PER_FRAME; i++) {
+        Tile* t = &cache->tiles[i];
+        if (!t->isVisible || t->state != TILE_UNLOADED) {
+            continue;
+        }
+
+        Uint64 bytes = (Uint64)t->entry.nPoints * TILE_BYTES_PER_POINT;
+        while (cache->residentBytes + bytes > cache->maxResidentBytes && evictLeastRecentlyUsed(cache)) {}
+
+        if (cache->residentBytes + bytes > cache->maxResidentBytes) {
+            continue;   // Everything left in memory is visible, but smaller tiles could still fit
+        }
+
+        cache->residentBytes += bytes;
+        t->state = TILE_REQUESTED;
+        cache->requests[(cache->requestsStart + cache->nRequests) % cache->header.nTiles] = i;
+        cache->nRequests++;
+        requestsThisFrame++;
+    }
+    if (requestsThisFrame > 0) {
+        SDL_SignalCondition(cache->hasRequests);
+    }
+    SDL_UnlockMutex(cache->lock);
+
+    // Only the visible tiles that are in memory can be drawn (resident tiles are only freed by this thread, so their points can be used without the lock)
+    Uint64 pointsToDraw = 0;
+    SDL_LockMutex(cache->lock);
+    for (Uint32 i = 0; i < cache->header.nTiles; i++) {
+        Tile* t = &cache->tiles[i];
+        t->isDrawable = t->isVisible && t->state == TILE_RESIDENT;
+        if (t->isDrawable) {
+            pointsToDraw += t->entry.nPoints;
+        }
+    }
+    SDL_UnlockMutex(cache->lock);
+
+    // If there are too many points, only one of every 'stride' points of each tile is drawn
+    const Uint32 stride = (pointsToDraw > pointBudget) ? (Uint32)((pointsToDraw + pointBudget - 1) / pointBudget) : 1;
+
+    Uint64 pointsDrawn = 0;
+    for (Uint32 i = 0; i < cache->header.nTiles; i++) {
+        Tile* t = &cache->tiles[i];
+        if (!t->isDrawable) {
+            continue;
+        }
+
+        // The points are only mapped again if the view (or the number of points drawn) changed since the last time
+        if (t->projectedVersion != cache->projectionVersion || t->projectedStride != stride) {
+            Uint32 n = 0;
+            for (Uint32 j = 0; j < t->entry.nPoints; j += stride) {
+                Vector3f p = rotateWithBasis(&t->points[j], view->rotationBasis, view->midPoint);
+                t->projected[n] = map3dTo2dWithBasis(&p, &camera, view->originX, view->originY);
+                n++;
+            }
+
+            t->nProjected = n;
+            t->projectedStride = stride;
+            t->projectedVersion = cache->projectionVersion;
+            t->projectedOrigin.x = view->originX;
+            t->projectedOrigin.y = view->originY;
+        }
+        else if (t->projectedOrigin.x != view->originX || t->projectedOrigin.y != view->originY) {
+            // Only a pan: the points are moved (same origin convention as map3dTo2d, i.e. the Y origin is negated)
+            translatePoints(t->projected, t->nProjected, view->originX - t->projectedOrigin.x, -(view->originY - t->projectedOrigin.y));
+            t->projectedOrigin.x = view->originX;
+            t->projectedOrigin.y = view->originY;
+        }
+
+        SDL_RenderPoints(r, t->projected, (int)t->nProjected);
+        pointsDrawn += t->nProjected;
+    }
+
+    return pointsDrawn;
+}
+
+
+void closeTileCache(TileCache* cache) {
+    if (cache == NULL) {
+        return;
+    }
+
+    if (cache->reader != NULL) {
+        SDL_LockMutex(cache->lock);
+        cache->quit = true;
+        SDL_SignalCondition(cache->hasRequests);
+        SDL_UnlockMutex(cache->lock);
+        SDL_WaitThread(cache->reader, NULL);
+    }
+
+    if (cache->tiles != NULL) {
+        for (Uint32 i = 0; i < cache->header.nTiles; i++) {
+            SDL_free(cache->tiles[i].points);
+            SDL_free(cache->tiles[i].projected);
+        }
+    }
+
+    if (cache->file != NULL) {
+        SDL_CloseIO(cache->file);
+    }
+    if (cache->hasRequests != NULL) {
+        SDL_DestroyCondition(cache->hasRequests);
+    }
+    if (cache->lock != NULL) {
+        SDL_DestroyMutex(cache->lock);
+    }
+
+    SDL_free(cache->tiles);
+    SDL_free(cache->requests);
+    SDL_free(cache);
+}
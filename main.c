@@ -7,6 +7,9 @@
 #include "include/Appstate.h"
 #include "include/FileParsing.h"
 #include "include/GeometryMath.h"
+#include "include/PointRendering.h"
+#include "include/TiledCloud.h"
+#include "include/InputReplay.h"
 
 
 // standalone function to draw text so that its contents can be later modified in case I decide to use libraries like SDL_ttf or similar in the future
@@ -14,44 +17,170 @@ void drawText(SDL_Renderer* r, float x, float y, const char* str) {
     SDL_RenderDebugText(r, x, y, str);
 }
 
-void checkForRotationInput(Appstate* as) {
+void checkForRotationInput(Appstate* as, const FrameInput* input) {
+    const float step = (input->heldKeys & INPUT_KEY_LSHIFT) ? ANGLE_STEP_DEG / 2.f : ANGLE_STEP_DEG;
+
     // ROTATE AROUND X AXIS
-    if (SDL_GetKeyboardState(NULL)[SDL_SCANCODE_W]) {
-        if (SDL_GetKeyboardState(NULL)[SDL_SCANCODE_LSHIFT]) {
-            as->geoHandle.rotationAngles.x += ANGLE_STEP_DEG / 2.f;
-        }
-        else {
-            as->geoHandle.rotationAngles.x += ANGLE_STEP_DEG;
-        }
+    if (input->heldKeys & INPUT_KEY_W) {
+        as->geoHandle.rotationAngles.x += step;
     }
-    if (SDL_GetKeyboardState(NULL)[SDL_SCANCODE_S]) {
-        if (SDL_GetKeyboardState(NULL)[SDL_SCANCODE_LSHIFT]) {
-            as->geoHandle.rotationAngles.x -= ANGLE_STEP_DEG / 2.f;
-        }
-        else {
-            as->geoHandle.rotationAngles.x -= ANGLE_STEP_DEG;
-        }
+    if (input->heldKeys & INPUT_KEY_S) {
+        as->geoHandle.rotationAngles.x -= step;
     }
 
     // ROTATE AROUND Y AXIS
-    if (SDL_GetKeyboardState(NULL)[SDL_SCANCODE_A]) {
-        if (SDL_GetKeyboardState(NULL)[SDL_SCANCODE_LSHIFT]) {
-            as->geoHandle.rotationAngles.y -= ANGLE_STEP_DEG / 2.f;
-        }
-        else {
-            as->geoHandle.rotationAngles.y -= ANGLE_STEP_DEG;
+    if (input->heldKeys & INPUT_KEY_A) {
+        as->geoHandle.rotationAngles.y -= step;
+    }
+    if (input->heldKeys & INPUT_KEY_D) {
+        as->geoHandle.rotationAngles.y += step;
+    }
+}
+
+// Gathers the input of this frame from the keyboard and mouse (along with what SDL_AppEvent noted since the last frame)
+void readLiveInput(Appstate* as, FrameInput* input) {
+    const bool* keys = SDL_GetKeyboardState(NULL);
+
+    input->ticks = SDL_GetTicks();
+    input->heldKeys = 0;
+    input->heldKeys |= keys[SDL_SCANCODE_W] ? INPUT_KEY_W : 0;
+    input->heldKeys |= keys[SDL_SCANCODE_S] ? INPUT_KEY_S : 0;
+    input->heldKeys |= keys[SDL_SCANCODE_A] ? INPUT_KEY_A : 0;
+    input->heldKeys |= keys[SDL_SCANCODE_D] ? INPUT_KEY_D : 0;
+    input->heldKeys |= keys[SDL_SCANCODE_LSHIFT] ? INPUT_KEY_LSHIFT : 0;
+    input->heldKeys |= keys[SDL_SCANCODE_R] ? INPUT_KEY_R : 0;
+    input->pressedKeys = as->ioHandle.pressedKeys;
+
+    SDL_GetMouseState(&input->mousePos.x, &input->mousePos.y);
+    input->mouseDown = as->ioHandle.checkMouse;
+    input->wheelY = as->ioHandle.wheelY;
+
+    as->ioHandle.pressedKeys = 0;
+    as->ioHandle.wheelY = 0.f;
+}
+
+// Applies everything in the input of this frame except the rotations (i.e. toggles, zoom, pan and reset)
+void applyFrameInput(Appstate* as, const FrameInput* input) {
+    // Toggle debug state
+    if (input->pressedKeys & INPUT_KEY_TAB) {
+        as->ioHandle.showDebugInfo = !as->ioHandle.showDebugInfo;
+    }
+
+    // Switch between drawing the points joined by lines or on their own
+    if (input->pressedKeys & INPUT_KEY_P) {
+        as->ioHandle.drawMode = (as->ioHandle.drawMode == DRAW_MODE_POLYLINE) ? DRAW_MODE_POINTS : DRAW_MODE_POLYLINE;
+    }
+
+    // Manage camera zoom with the mouse wheel
+    if (input->wheelY != 0.f) {
+        // Remember camzvalue will usually be +ve
+        const float zoomStep = (input->heldKeys & INPUT_KEY_LSHIFT) ? input->wheelY / 2 : input->wheelY * 5;
+        if (as->geoHandle.zCamValue - zoomStep >= 0.0) {
+            as->geoHandle.zCamValue -= zoomStep;
+            as->ioHandle.computeScreenTransform = true;
         }
     }
-    if (SDL_GetKeyboardState(NULL)[SDL_SCANCODE_D]) {
-        if (SDL_GetKeyboardState(NULL)[SDL_SCANCODE_LSHIFT]) {
-            as->geoHandle.rotationAngles.y += ANGLE_STEP_DEG / 2.f;
+
+    // Move the points around while a mouse button is held
+    if (input->mouseDown) {
+        as->geoHandle.originXY.x += input->mousePos.x - as->ioHandle.oldMousePos.x;
+        as->geoHandle.originXY.y -= input->mousePos.y - as->ioHandle.oldMousePos.y;
+
+        // Panning is only a movement in 2D, so the points don't have to be mapped again
+        as->ioHandle.computeScreenTransform = true;
+    }
+    as->ioHandle.oldMousePos = input->mousePos;
+
+    // Resets points to their original positions if the 'R' key is pressed
+    if (input->heldKeys & INPUT_KEY_R) {
+        
+        // Only reset if there have been any changes since start
+        if (as->geoHandle.rotationAngles.x != 0 || as->geoHandle.rotationAngles.y != 0 || as->geoHandle.rotationAngles.z != 0) {
+            // Points are never rotated in place, so resetting the rotations is enough
+            as->geoHandle.rotationAngles = makeVector3f(0, 0, 0);       // This is because we have also re-set the angles
+            as->geoHandle.rotationBasis[0] = makeVector3f(1, 0, 0);
+            as->geoHandle.rotationBasis[1] = makeVector3f(0, 1, 0);
+            as->geoHandle.rotationBasis[2] = makeVector3f(0, 0, 1);
         }
-        else {
-            as->geoHandle.rotationAngles.y += ANGLE_STEP_DEG;
+
+        if (as->geoHandle.zCamValue != DEFAULT_CAM_ZVALUE) {
+            as->geoHandle.zCamValue = DEFAULT_CAM_ZVALUE;
+        }
+
+        if (as->geoHandle.originXY.x != DEFAULT_ORIGIN_X(as->scaler.windowWidth) || as->geoHandle.originXY.y != DEFAULT_ORIGIN_Y(as->scaler.windowHeight)) {
+            as->geoHandle.originXY.x = DEFAULT_ORIGIN_X(as->scaler.windowWidth);
+            as->geoHandle.originXY.y = DEFAULT_ORIGIN_Y(as->scaler.windowHeight);
         }
+
+        as->ioHandle.computeTransformations = true;
     }
 }
 
+// Returns the state of the camera (used to check replays against their recording)
+CameraState getCameraState(const Appstate* as) {
+    CameraState state;
+    state.rotationAngles = as->geoHandle.rotationAngles;
+    state.zCamValue = as->geoHandle.zCamValue;
+    state.originXY = as->geoHandle.originXY;
+    return state;
+}
+
+// Returns a hash of everything that defines what is drawn (used to compare the final state of replays between builds).
+// Every point is mapped here, as the points mapped while drawing depend on the point budget (i.e. on how long the frames took)
+Uint64 getStateChecksum(const Appstate* as) {
+    Uint64 hash = FNV_OFFSET_BASIS;
+    hash = hashBytes(hash, as->geoHandle.pointsArray_3d, as->geoHandle.nPoints * sizeof(Vector3f));
+
+    Vector3f cameraPos = makeVector3f(as->geoHandle.zCamValue, as->geoHandle.zCamValue, as->geoHandle.zCamValue);
+    Vector3f cameraTarget = makeVector3f(0, 0, 0);
+    Vector3f cameraUp = makeVector3f(0, 1, 0);
+    const CameraBasis camera = makeCameraBasis(&cameraPos, &cameraTarget, &cameraUp, FOV_Y_DEG, as->scaler.windowWidth, as->scaler.windowHeight);
+    for (unsigned long i = 0; i < as->geoHandle.nPoints; i++) {
+        Vector3f p = rotateWithBasis(&as->geoHandle.pointsArray_3d[i], as->geoHandle.rotationBasis, &as->geoHandle.midPoint);
+        SDL_FPoint mapped = map3dTo2dWithBasis(&p, &camera, as->geoHandle.originXY.x, as->geoHandle.originXY.y);
+        hash = hashBytes(hash, &mapped, sizeof(SDL_FPoint));
+    }
+
+    hash = hashBytes(hash, as->geoHandle.rotationBasis, sizeof(as->geoHandle.rotationBasis));
+    hash = hashBytes(hash, &as->geoHandle.rotationAngles, sizeof(Vector3f));
+    hash = hashBytes(hash, &as->geoHandle.zCamValue, sizeof(float));
+    hash = hashBytes(hash, &as->geoHandle.originXY, sizeof(SDL_FPoint));
+    return hash;
+}
+
+
+// Prints how the program has to be called
+void printUsage(const char* program) {
+    printf(
+        "Usage: %s [points file] [--cache-mb <MB>] [--render-scale <scale>] [--target-ms <ms>]\n"
+        "          [--record <file> | --replay <file> [--timings <file>] [--headless]]\n",
+        program
+    );
+}
+
+// Prints what is wrong with the command line arguments ('problem' is a format with a single %s, replaced by 'arg') and how the program
+// has to be called. Returns SDL_APP_FAILURE so that the caller can return it directly
+SDL_AppResult rejectArguments(const char* program, const char* problem, const char* arg) {
+    printf(problem, arg);
+    printf("\n");
+    printUsage(program);
+    return SDL_APP_FAILURE;
+}
+
+// Reads the number in 'text' into 'value'. Returns false if 'text' isn't a number or has anything after it
+bool parseNumber(const char* text, double* value) {
+    char* end;
+    *value = SDL_strtod(text, &end);
+    return end != text && *end == '\0';
+}
+
+// Same as parseNumber for whole numbers that can't be negative
+bool parseUnsigned(const char* text, Uint64* value) {
+    char* end;
+    *value = SDL_strtoull(text, &end, 10);
+    return text[0] >= '0' && text[0] <= '9' && *end == '\0';
+}
+
 
 /* This function runs once at startup. */
 SDL_AppResult SDL_AppInit(void** appstate, int argc, char* argv[]) {
@@ -62,49 +191,206 @@ SDL_AppResult SDL_AppInit(void** appstate, int argc, char* argv[]) {
         return SDL_APP_FAILURE;
     }
 
-    /* Create the window */
-    if (!SDL_CreateWindowAndRenderer("3D Point viewer", WIN_WIDTH, WIN_HEIGHT, 0, &as->window, &as->render)) {
+    *appstate = as;     // Set early so that SDL_AppQuit can free everything if anything below fails
+    
+    as->ioHandle = defaultInOutHandle();
+    as->geoHandle = defaultGeometryHandle();
+    as->axesSet = defaultAxes(100.f);
+
+    // Reading the command line arguments (see printUsage)
+    Uint64 cacheMb = DEFAULT_TILE_CACHE_MB;
+    float renderScale = 0.f;            // 0 means that the internal resolution is adapted to the frame time
+    double targetMs = MS_PER_FRAME;
+    const char* recordFname = NULL;
+    const char* replayFname = NULL;
+    const char* timingsFname = NULL;
+    bool headless = false;
+    bool hasPointsFname = false;
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+
+        // Anything that isn't an option is the points file
+        if (SDL_strncmp(arg, "--", 2) != 0) {
+            if (hasPointsFname) {
+                return rejectArguments(argv[0], "More than one points file given ('%s')", arg);
+            }
+            as->geoHandle.pointsFname = arg;
+            hasPointsFname = true;
+            continue;
+        }
+
+        if (SDL_strcmp(arg, "--headless") == 0) {
+            headless = true;
+            continue;
+        }
+
+        // Every other option is followed by a value (which can't be another option)
+        const bool isKnown = SDL_strcmp(arg, "--cache-mb") == 0 || SDL_strcmp(arg, "--render-scale") == 0 || SDL_strcmp(arg, "--target-ms") == 0
+            || SDL_strcmp(arg, "--record") == 0 || SDL_strcmp(arg, "--replay") == 0 || SDL_strcmp(arg, "--timings") == 0;
+        if (!isKnown) {
+            return rejectArguments(argv[0], "Unknown option '%s'", arg);
+        }
+        if (i + 1 >= argc || SDL_strncmp(argv[i + 1], "--", 2) == 0) {
+            return rejectArguments(argv[0], "Missing value for '%s'", arg);
+        }
+        const char* value = argv[++i];
+
+        if (SDL_strcmp(arg, "--cache-mb") == 0) {
+            if (!parseUnsigned(value, &cacheMb) || cacheMb == 0 || cacheMb > MAX_TILE_CACHE_MB) {
+                return rejectArguments(argv[0], "'%s' is not a valid number of MB for '--cache-mb'", value);
+            }
+        }
+        else if (SDL_strcmp(arg, "--render-scale") == 0) {
+            double scale;
+            if (!parseNumber(value, &scale) || !(scale > 0.0 && scale <= 1.0)) {
+                return rejectArguments(argv[0], "'%s' is not a valid scale for '--render-scale' (it must be more than 0 and at most 1)", value);
+            }
+            renderScale = (float)scale;
+        }
+        else if (SDL_strcmp(arg, "--target-ms") == 0) {
+            if (!parseNumber(value, &targetMs) || !(targetMs > 0.0)) {
+                return rejectArguments(argv[0], "'%s' is not a valid frame time for '--target-ms'", value);
+            }
+        }
+        else if (SDL_strcmp(arg, "--record") == 0) {
+            recordFname = value;
+        }
+        else if (SDL_strcmp(arg, "--replay") == 0) {
+            replayFname = value;
+        }
+        else {
+            timingsFname = value;
+        }
+    }
+
+    // Options that only make sense together (or can't be used together)
+    if (recordFname != NULL && replayFname != NULL) {
+        return rejectArguments(argv[0], "'%s' and '--replay' can't be used at the same time", "--record");
+    }
+    if (replayFname == NULL && (timingsFname != NULL || headless)) {
+        return rejectArguments(argv[0], "'%s' can only be used along with '--replay'", (timingsFname != NULL) ? "--timings" : "--headless");
+    }
+
+    // The starting mouse position is part of the recording too, as the first pan depends on it (and so is the window size, see below)
+    if (replayFname != NULL) {
+        if (!openInputReplay(&as->inputLog, replayFname, &as->ioHandle.oldMousePos)) {
+            return SDL_APP_FAILURE;
+        }
+        as->inputLog.timingsFname = timingsFname;
+    }
+
+    // Headless runs don't need a display at all (i.e. on machines without one), so SDL's offscreen video driver is used.
+    // The hint has to be set before the video subsystem is initialized, which happens when the window is created
+    if (headless) {
+        SDL_SetHint(SDL_HINT_VIDEO_DRIVER, "offscreen");
+    }
+
+    /* Create the window (hidden when running headless, everything is still rendered) */
+    // The view depends on the window size, so replays use the size of the recording and resizes are not allowed while recording or replaying
+    const bool isSizeFixed = replayFname != NULL || recordFname != NULL;
+    const int createWidth = (replayFname != NULL) ? as->inputLog.windowWidth : WIN_WIDTH;
+    const int createHeight = (replayFname != NULL) ? as->inputLog.windowHeight : WIN_HEIGHT;
+    const SDL_WindowFlags windowFlags = (isSizeFixed ? 0 : SDL_WINDOW_RESIZABLE) | (headless ? SDL_WINDOW_HIDDEN : 0);
+    if (!SDL_CreateWindowAndRenderer("3D Point viewer", createWidth, createHeight, windowFlags, &as->window, &as->render)) {
         SDL_Log("Couldn't create window and renderer: %s", SDL_GetError());
         return SDL_APP_FAILURE;
     }
 
+    // The window size in pixels may differ from the one requested (i.e. in high DPI screens)
+    int windowWidth, windowHeight;
+    SDL_GetWindowSizeInPixels(as->window, &windowWidth, &windowHeight);
+    if (replayFname != NULL && (windowWidth != as->inputLog.windowWidth || windowHeight != as->inputLog.windowHeight)) {
+        printf("The recording was made with a %dx%d window, but the window is %dx%d pixels here\n",
+            as->inputLog.windowWidth, as->inputLog.windowHeight, windowWidth, windowHeight);
+        return SDL_APP_FAILURE;
+    }
+    if (recordFname != NULL && !openInputRecording(&as->inputLog, recordFname, &as->ioHandle.oldMousePos, windowWidth, windowHeight)) {
+        return SDL_APP_FAILURE;
+    }
+    as->scaler = defaultRenderScaler(windowWidth, windowHeight);
+    as->scaler.targetFrameMs = targetMs;
+    if (renderScale > 0.f) {
+        fixRenderScale(&as->scaler, as->render, renderScale);     // If it fails, everything is drawn at full resolution
+    }
+    as->geoHandle.originXY.x = DEFAULT_ORIGIN_X(windowWidth);
+    as->geoHandle.originXY.y = DEFAULT_ORIGIN_Y(windowHeight);
+
     as->last_frame = SDL_GetTicks();
+
+    // Tiled files are never loaded completely, their tiles are read while drawing when the camera can see them
+    if (isTiledFile(as->geoHandle.pointsFname)) {
+        as->tileCache = openTileCache(as->geoHandle.pointsFname, cacheMb * 1024 * 1024);
+        if (as->tileCache == NULL) {
+            return SDL_APP_FAILURE;
+        }
+        as->geoHandle.midPoint = as->tileCache->header.midPoint;
+
+        return SDL_APP_CONTINUE;
+    }
     
-    
-    as->ioHandle = defaultInOutHandle();
-    as->geoHandle = defaultGeometryHandle();
-    as->axesSet = defaultAxes(100.f);
-    
-    printf("Reading points from '%s' file...\n", POINTS_FNAME);
-    as->geoHandle.pointsArray_3d = readPointsFromFile(&as->geoHandle.nPoints, POINTS_FNAME);
+    printf("Reading points from '%s' file...\n", as->geoHandle.pointsFname);
+    as->geoHandle.pointsArray_3d = readPointsFromFile(&as->geoHandle.nPoints, as->geoHandle.pointsFname, &as->geoHandle.attributes);
     printf("Points read, mapping them to 2D...\n");
 
+    // Preparing the colors of the points (if the file had any attributes)
+    if (as->geoHandle.attributes.type == POINT_ATTRIBUTES_SCALAR) {
+        applyColormap(
+            as->geoHandle.attributes.scalars, as->geoHandle.attributes.colors, as->geoHandle.nPoints,
+            as->geoHandle.attributes.minScalar, as->geoHandle.attributes.maxScalar
+        );
+    }
+    if (as->geoHandle.attributes.type != POINT_ATTRIBUTES_NONE) {
+        if (!createPointBatch(&as->pointBatch, as->geoHandle.attributes.colors, as->geoHandle.nPoints)) {
+            perror("Unable to allocate memory for the colored points\n");
+            return SDL_APP_FAILURE;
+        }
+    }
+
 
     // Calculating 2D ('mapped') versions of the 3D points
     as->geoHandle.pointsArray = (SDL_FPoint*)SDL_calloc(as->geoHandle.nPoints, sizeof(SDL_FPoint));
+    as->geoHandle.pointsArrayProjected = (SDL_FPoint*)SDL_calloc(as->geoHandle.nPoints, sizeof(SDL_FPoint));
 
     Vector3f cameraPos = makeVector3f(as->geoHandle.zCamValue, as->geoHandle.zCamValue, as->geoHandle.zCamValue);
     Vector3f cameraTarget = makeVector3f(0, 0, 0);
     Vector3f cameraUp = makeVector3f(0, 1, 0);
+    const CameraBasis camera = makeCameraBasis(&cameraPos, &cameraTarget, &cameraUp, FOV_Y_DEG, as->scaler.windowWidth, as->scaler.windowHeight);
 
     for (unsigned long i = 0; i < as->geoHandle.nPoints; i++) {
-        as->geoHandle.pointsArray[i] = map3dTo2d(
-            &as->geoHandle.pointsArray_3d[i],
-            &cameraPos,
-            &cameraTarget,
-            &cameraUp,
-            FOV_Y_DEG,
-            as->geoHandle.originXY.x, as->geoHandle.originXY.y,
-            WIN_WIDTH, WIN_HEIGHT
-        );
+        as->geoHandle.pointsArrayProjected[i] = map3dTo2dWithBasis(&as->geoHandle.pointsArray_3d[i], &camera, 0.f, 0.f);
     }
+    as->geoHandle.nProjected = as->geoHandle.nPoints;
+    as->geoHandle.projectedStride = 1;
+    as->geoHandle.projectedCamValue = as->geoHandle.zCamValue;
+
+    // Pans and zooms are applied afterwards to the mapped points
+    applyScreenTransform(
+        as->geoHandle.pointsArrayProjected, as->geoHandle.pointsArray, as->geoHandle.nPoints,
+        1.f, as->geoHandle.originXY.x, as->geoHandle.originXY.y
+    );
+    as->geoHandle.drawnScale = 1.f;
+    as->geoHandle.drawnOriginXY = as->geoHandle.originXY;
     printf("Points mapped from 3D to 2D coordinates\n");
 
+    if (!createSimplifiedPolyline(&as->polyline, as->geoHandle.nPoints)) {
+        perror("Unable to allocate memory for the simplified polyline\n");
+        return SDL_APP_FAILURE;
+    }
+
     // Calculating middle point
     as->geoHandle.midPoint = getPointsCenter(as->geoHandle.pointsArray_3d, as->geoHandle.nPoints);
     printf("Calculated middle point for all the 3D points, drawing window...\n");
 
-    *appstate = as;
+    // Rotations happen around the middle point, so the distance from it to each point never changes
+    float maxDistance = 0.f;
+    for (unsigned long i = 0; i < as->geoHandle.nPoints; i++) {
+        Vector3f rel = subtract(&as->geoHandle.pointsArray_3d[i], &as->geoHandle.midPoint);
+        float distance = (float)sqrt(dotProduct(&rel, &rel));
+        if (distance > maxDistance) {
+            maxDistance = distance;
+        }
+    }
+    as->geoHandle.boundingRadius = (float)sqrt(dotProduct(&as->geoHandle.midPoint, &as->geoHandle.midPoint)) + maxDistance;
     
     return SDL_APP_CONTINUE;
 }
@@ -129,47 +415,26 @@ SDL_AppResult SDL_AppEvent(void* appstate, SDL_Event* event)
         as->ioHandle.checkMouse = false;
     }
 
-    // Toggle debug state
+    // Toggles are noted here and applied in the next frame (so that they can be recorded along with the rest of the input)
     if (event->type == SDL_EVENT_KEY_DOWN && SDL_GetKeyboardState(NULL)[SDL_SCANCODE_TAB]) {
-        as->ioHandle.showDebugInfo = !as->ioHandle.showDebugInfo;
+        as->ioHandle.pressedKeys |= INPUT_KEY_TAB;
+    }
+    if (event->type == SDL_EVENT_KEY_DOWN && SDL_GetKeyboardState(NULL)[SDL_SCANCODE_P]) {
+        as->ioHandle.pressedKeys |= INPUT_KEY_P;
     }
 
-    // Manage camera zoom with the mouse wheel
+    // Same with the zoom
     if (event->type == SDL_EVENT_MOUSE_WHEEL) {
-        // Remember camzvalue will usually be +ve
-        if (SDL_GetKeyboardState(NULL)[SDL_SCANCODE_LSHIFT]) {
-            if (as->geoHandle.zCamValue - event->wheel.y / 2 >= 0.0) {
-                as->geoHandle.zCamValue -= event->wheel.y / 2;
-                as->ioHandle.computeTransformations = true;
-            }
-        }
-        else {
-            if (as->geoHandle.zCamValue - event->wheel.y * 5 >= 0.0) {
-                as->geoHandle.zCamValue -= event->wheel.y * 5;
-                as->ioHandle.computeTransformations = true;
-            }
-        }
+        as->ioHandle.wheelY += event->wheel.y;
     }
 
-    // Resets points to their original positions if the 'R' key is pressed
-    if (SDL_GetKeyboardState(NULL)[SDL_SCANCODE_R]) {
-        
-        // Only reset if there have been any changes since start
-        if (as->geoHandle.rotationAngles.x != 0 || as->geoHandle.rotationAngles.y != 0 || as->geoHandle.rotationAngles.z != 0) {
-            SDL_free(as->geoHandle.pointsArray_3d);     // Delete the old array
-            as->geoHandle.pointsArray_3d = readPointsFromFile(&as->geoHandle.nPoints, POINTS_FNAME);    // Re-read the points to reset the view
-
-            as->geoHandle.rotationAngles = makeVector3f(0, 0, 0);       // This is because we have also re-set the angles
-        }
-
-        if (as->geoHandle.zCamValue != DEFAULT_CAM_ZVALUE) {
-            as->geoHandle.zCamValue = DEFAULT_CAM_ZVALUE;
-        }
+    // The window was resized: the points are kept centered the same way and mapped again for the new screen size
+    if (event->type == SDL_EVENT_WINDOW_PIXEL_SIZE_CHANGED) {
+        as->geoHandle.originXY.x += (event->window.data1 - as->scaler.windowWidth) / 2.f;
+        as->geoHandle.originXY.y -= (event->window.data2 - as->scaler.windowHeight) / 2.f;
 
-        if (as->geoHandle.originXY.x != DEFAULT_ORIGIN_X || as->geoHandle.originXY.y != DEFAULT_ORIGIN_Y) {
-            as->geoHandle.originXY.x = DEFAULT_ORIGIN_X;
-            as->geoHandle.originXY.y = DEFAULT_ORIGIN_Y;
-        }
+        resizeRenderScaler(&as->scaler, as->render, event->window.data1, event->window.data2);
+        as->ioHandle.computeTransformations = true;
     }
 
     return SDL_APP_CONTINUE;
@@ -181,79 +446,198 @@ SDL_AppResult SDL_AppIterate(void* appstate) {
 
     Appstate* as = (Appstate*)appstate;
 
-    SDL_FPoint newMousePos;
-    SDL_GetMouseState(&newMousePos.x, &newMousePos.y);
-
-    if (as->ioHandle.checkMouse) {
-        as->geoHandle.originXY.x += newMousePos.x - as->ioHandle.oldMousePos.x;
-        as->geoHandle.originXY.y -= newMousePos.y - as->ioHandle.oldMousePos.y;
-
-        as->ioHandle.computeTransformations = true;
-    }
-    as->ioHandle.oldMousePos = newMousePos;
-
     const Uint64 now = SDL_GetTicks();
 
-    // z coord acts like 'zoom' (i.e. +ve values = more zoom; -ve values = less zoom)
-    // Change proportions between x, y & z coords in order to change perspective
-    Vector3f cameraPos = makeVector3f(as->geoHandle.zCamValue, as->geoHandle.zCamValue, as->geoHandle.zCamValue);
-    
-    Vector3f cameraTarget = makeVector3f( 0, 0, 0);          // Point at which the camera is looking
-    Vector3f cameraUp = makeVector3f(0, 1, 0);               // Up direction (i.e. +Y axis)
-
-
-    if ((now - as->last_frame) >= MS_PER_FRAME) {
+    // Replays run with a fixed timestep (i.e. one recorded frame per iteration, as fast as possible)
+    if (as->inputLog.isReplaying || (now - as->last_frame) >= MS_PER_FRAME) {
         as->last_frame = now;
+        const Uint64 frameStart = SDL_GetPerformanceCounter();
+
+        FrameInput input;
+        CameraState expectedState;
+        if (as->inputLog.isReplaying) {
+            // The replay fails if it didn't do the same as the recording
+            if (!readFrameInput(&as->inputLog, &input, &expectedState)) {
+                return printReplayReport(&as->inputLog, getStateChecksum(as)) ? SDL_APP_SUCCESS : SDL_APP_FAILURE;
+            }
+        }
+        else {
+            readLiveInput(as, &input);
+        }
+
+        applyFrameInput(as, &input);
 
         Vector3f oldAngles = as->geoHandle.rotationAngles;
-        checkForRotationInput(as);
+        checkForRotationInput(as, &input);
+
+        if (as->inputLog.isRecording) {
+            CameraState state = getCameraState(as);
+            recordFrameInput(&as->inputLog, &input, &state);
+        }
+
+        // z coord acts like 'zoom' (i.e. +ve values = more zoom; -ve values = less zoom)
+        // Change proportions between x, y & z coords in order to change perspective
+        Vector3f cameraPos = makeVector3f(as->geoHandle.zCamValue, as->geoHandle.zCamValue, as->geoHandle.zCamValue);
+        
+        Vector3f cameraTarget = makeVector3f( 0, 0, 0);          // Point at which the camera is looking
+        Vector3f cameraUp = makeVector3f(0, 1, 0);               // Up direction (i.e. +Y axis)
 
         Vector3f angles = subtract(&as->geoHandle.rotationAngles, &oldAngles);
 
+        // Keeping track of all the rotations applied so far (points are rotated with them only when they are mapped)
+        const Vector3f zero = makeVector3f(0, 0, 0);
+        for (unsigned i = 0; i < 3; i++) {
+            rotateVector3f(&as->geoHandle.rotationBasis[i], &zero, angles.x, angles.y, 0.0);
+        }
+
         // This will be positive if the points are in a different coordinate than the last iteration,
-        // i.e. a rotation happened, the user zoomed out etc.
+        // i.e. a rotation happened, the points were reset etc.
         as->ioHandle.computeTransformations = 
-            as->ioHandle.computeTransformations || as->geoHandle.rotationAngles.x != 0 || as->geoHandle.rotationAngles.y != 0;
+            as->ioHandle.computeTransformations || angles.x != 0 || angles.y != 0;
+
+        // A zoom can be applied by scaling the mapped points only if the error made by doing so can't be noticed
+        // (the camera is at (z, z, z), so its distance to the target is z * sqrt(3))
+        if (as->ioHandle.computeScreenTransform && !as->ioHandle.computeTransformations
+            && as->geoHandle.zCamValue != as->geoHandle.projectedCamValue
+            && !isZoomScalable(
+                as->geoHandle.boundingRadius,
+                as->geoHandle.projectedCamValue * sqrt(3.0), as->geoHandle.zCamValue * sqrt(3.0),
+                FOV_Y_DEG, as->scaler.windowWidth, as->scaler.windowHeight, ZOOM_SCALE_TOLERANCE_PX)) {
+            as->ioHandle.computeTransformations = true;
+        }
+
+        bool viewChanged = as->ioHandle.computeTransformations || as->ioHandle.computeScreenTransform;
+
+        // When there are more points than the budget allows, only one of every 'stride' points is rotated and mapped
+        // (so the points have to be mapped again when the budget changes, even if the view didn't)
+        const unsigned long stride = (unsigned long)budgetStride(&as->scaler, as->geoHandle.nPoints);     // Never more than nPoints, so it always fits
+        as->ioHandle.computeTransformations = as->ioHandle.computeTransformations || stride != as->geoHandle.projectedStride;
+
+        bool pointsMapped = as->ioHandle.computeTransformations;
 
-        // If there is any rotation
+        // If there is any rotation (or a zoom that can't be done by scaling, or a new point budget)
         if (as->ioHandle.computeTransformations) {
+            // The camera is the same for every point, so it is only calculated once
+            const CameraBasis camera = makeCameraBasis(&cameraPos, &cameraTarget, &cameraUp, FOV_Y_DEG, as->scaler.windowWidth, as->scaler.windowHeight);
+
+            // For every point that is drawn
+            unsigned long n = 0;
+            for (unsigned long i = 0; i < as->geoHandle.nPoints; i += stride) {
+                // We rotate it (the original point is kept as it is)
+                Vector3f p = rotateWithBasis(&as->geoHandle.pointsArray_3d[i], as->geoHandle.rotationBasis, &as->geoHandle.midPoint);
+
+                // And then we calculate its 2D equivalent (pans and zooms are applied afterwards)
+                as->geoHandle.pointsArrayProjected[n] = map3dTo2dWithBasis(&p, &camera, 0.f, 0.f);
+                n++;
+            }
+
+            as->geoHandle.nProjected = n;
+            as->geoHandle.projectedStride = stride;
+            as->geoHandle.projectedCamValue = as->geoHandle.zCamValue;
+            as->ioHandle.computeTransformations = false;
+            as->ioHandle.computeScreenTransform = true;
+        }
 
-            // For every point
-            for (unsigned i = 0; i < as->geoHandle.nPoints; i++) {
-                // We rotate it
-                rotateVector3f(&as->geoHandle.pointsArray_3d[i], &as->geoHandle.midPoint, angles.x, angles.y, 0.0);
-                
-                // And then we calculate its 2D equivalent
-                as->geoHandle.pointsArray[i] = map3dTo2d(
-                    &as->geoHandle.pointsArray_3d[i], 
-                    &cameraPos, 
-                    &cameraTarget, 
-                    &cameraUp, 
-                    FOV_Y_DEG, 
-                    as->geoHandle.originXY.x, as->geoHandle.originXY.y, 
-                    WIN_WIDTH, WIN_HEIGHT
+        // If the points were panned or zoomed (or mapped again)
+        if (as->ioHandle.computeScreenTransform) {
+            float scale = 1.f;
+            if (as->geoHandle.zCamValue != as->geoHandle.projectedCamValue) {
+                scale = as->geoHandle.projectedCamValue / as->geoHandle.zCamValue;
+            }
+
+            if (!pointsMapped && scale == as->geoHandle.drawnScale) {
+                // Only a pan: everything that was already built from the 2D points can be moved as well
+                float dx = as->geoHandle.originXY.x - as->geoHandle.drawnOriginXY.x;
+                float dy = -(as->geoHandle.originXY.y - as->geoHandle.drawnOriginXY.y);
+
+                if (dx != 0.f || dy != 0.f) {
+                    translatePoints(as->geoHandle.pointsArray, as->geoHandle.nProjected, dx, dy);
+                    if (as->polyline.isValid) {
+                        translatePoints(as->polyline.points, as->polyline.nPoints, dx, dy);
+                    }
+                    if (as->pointBatch.isValid) {
+                        translatePointBatch(&as->pointBatch, dx, dy);
+                    }
+                }
+            }
+            else {
+                applyScreenTransform(
+                    as->geoHandle.pointsArrayProjected, as->geoHandle.pointsArray, as->geoHandle.nProjected,
+                    scale, as->geoHandle.originXY.x, as->geoHandle.originXY.y
                 );
+
+                // The 2D points changed, so the colored vertices and the simplified polyline have to be rebuilt
+                as->pointBatch.isValid = false;
+                as->polyline.isValid = false;
             }
+
+            as->geoHandle.drawnScale = scale;
+            as->geoHandle.drawnOriginXY = as->geoHandle.originXY;
+            as->ioHandle.computeScreenTransform = false;
         }
         
         // Preparing the axes to be drawn
-        SDL_FPoint origin = map3dTo2d(&as->axesSet.origin, &cameraPos, &cameraTarget, &cameraUp, FOV_Y_DEG, as->geoHandle.originXY.x, as->geoHandle.originXY.y, WIN_WIDTH, WIN_HEIGHT);
-        SDL_FPoint xaxis = map3dTo2d(&as->axesSet.xAxis, &cameraPos, &cameraTarget, &cameraUp, FOV_Y_DEG, as->geoHandle.originXY.x, as->geoHandle.originXY.y, WIN_WIDTH, WIN_HEIGHT);
-        SDL_FPoint yaxis = map3dTo2d(&as->axesSet.yAxis, &cameraPos, &cameraTarget, &cameraUp, FOV_Y_DEG, as->geoHandle.originXY.x, as->geoHandle.originXY.y, WIN_WIDTH, WIN_HEIGHT);
-        SDL_FPoint zaxis = map3dTo2d(&as->axesSet.zAxis, &cameraPos, &cameraTarget, &cameraUp, FOV_Y_DEG, as->geoHandle.originXY.x, as->geoHandle.originXY.y, WIN_WIDTH, WIN_HEIGHT);
+        SDL_FPoint origin = map3dTo2d(&as->axesSet.origin, &cameraPos, &cameraTarget, &cameraUp, FOV_Y_DEG, as->geoHandle.originXY.x, as->geoHandle.originXY.y, as->scaler.windowWidth, as->scaler.windowHeight);
+        SDL_FPoint xaxis = map3dTo2d(&as->axesSet.xAxis, &cameraPos, &cameraTarget, &cameraUp, FOV_Y_DEG, as->geoHandle.originXY.x, as->geoHandle.originXY.y, as->scaler.windowWidth, as->scaler.windowHeight);
+        SDL_FPoint yaxis = map3dTo2d(&as->axesSet.yAxis, &cameraPos, &cameraTarget, &cameraUp, FOV_Y_DEG, as->geoHandle.originXY.x, as->geoHandle.originXY.y, as->scaler.windowWidth, as->scaler.windowHeight);
+        SDL_FPoint zaxis = map3dTo2d(&as->axesSet.zAxis, &cameraPos, &cameraTarget, &cameraUp, FOV_Y_DEG, as->geoHandle.originXY.x, as->geoHandle.originXY.y, as->scaler.windowWidth, as->scaler.windowHeight);
 
         const SDL_FPoint xAxisLine[] = { origin, xaxis };
         const SDL_FPoint yAxisLine[] = { origin, yaxis };
         const SDL_FPoint zAxisLine[] = { origin, zaxis };
 
 
+        // Everything is drawn at the internal resolution, and stretched to the window at the end
+        beginScaledFrame(&as->scaler, as->render);
+
         // Drawing the background
         SDL_SetRenderDrawColor(as->render, BG_COLOR);
         SDL_RenderClear(as->render);
 
-        // Drawing the lines joining points
+        // Number of primitives sent to the renderer for the points (segments in polyline mode, points in points mode)
+        Uint64 submittedCount = 0;
+        bool hasColors = as->geoHandle.attributes.type != POINT_ATTRIBUTES_NONE;
+
         SDL_SetRenderDrawColor(as->render, 0xFF, 0xFF, 0xFF, 0xFF);
-        SDL_RenderLines(as->render, as->geoHandle.pointsArray, as->geoHandle.nPoints);
+        if (as->tileCache != NULL) {
+            // Tiled files are always drawn as points, as the order of the points is lost when splitting them in tiles
+            TileView view;
+            view.rotationBasis = as->geoHandle.rotationBasis;
+            view.midPoint = &as->geoHandle.midPoint;
+            view.cameraPos = &cameraPos;
+            view.cameraTarget = &cameraTarget;
+            view.cameraUp = &cameraUp;
+            view.originX = as->geoHandle.originXY.x;
+            view.originY = as->geoHandle.originXY.y;
+            view.screenWidth = as->scaler.windowWidth;
+            view.screenHeight = as->scaler.windowHeight;
+
+            submittedCount = drawTileCache(as->tileCache, as->render, &view, as->scaler.pointBudget);
+        }
+        else if (as->ioHandle.drawMode == DRAW_MODE_POLYLINE) {
+            // Drawing the lines joining the mapped points (only simplified again if the points moved)
+            if (!as->polyline.isValid) {
+                simplifyPolyline(&as->polyline, as->geoHandle.pointsArray, as->geoHandle.nProjected, SIMPLIFY_TOLERANCE_PX);
+            }
+
+            SDL_RenderLines(as->render, as->polyline.points, as->polyline.nPoints);
+            submittedCount = (as->polyline.nPoints > 0) ? as->polyline.nPoints - 1 : 0;
+        }
+        else {
+            // Without colors, all the mapped points are drawn at once as single pixels
+            submittedCount = as->geoHandle.nProjected;
+            if (!hasColors) {
+                SDL_RenderPoints(as->render, as->geoHandle.pointsArray, (int)as->geoHandle.nProjected);
+            }
+        }
+
+        // Drawing the colored points (all of them in a single batch, which is reused while the points don't move)
+        if (hasColors) {
+            if (!as->pointBatch.isValid) {
+                updatePointBatch(&as->pointBatch, as->geoHandle.pointsArray, as->geoHandle.nProjected, as->geoHandle.projectedStride, POINT_SIZE_PX);
+            }
+            drawPointBatch(as->render, &as->pointBatch);
+        }
 
         // Drawing the sets of axes (X: Red, Y: Green, Z: Blue)
         SDL_SetRenderDrawColor(as->render, 0xFF, 0x20, 0x20, 0xFF);
@@ -268,7 +652,7 @@ SDL_AppResult SDL_AppIterate(void* appstate) {
         if (as->ioHandle.showDebugInfo) {
             // Drawing points in the canvas
             SDL_SetRenderDrawColor(as->render, 0x77, 0x77, 0x77, 0xFF);
-            for (unsigned i = 0; i < as->geoHandle.nPoints; i++) {
+            for (unsigned long i = 0; i < as->geoHandle.nProjected; i++) {
                 SDL_FRect pt;
                 pt.w = pt.h = 4;
                 pt.x = as->geoHandle.pointsArray[i].x - pt.h / 2;
@@ -278,11 +662,12 @@ SDL_AppResult SDL_AppIterate(void* appstate) {
 
                 // Draws points' 3D coordinates
                 char pointText[50];
-                sprintf(pointText, "(%.3f, %.3f, %.3f)\0", as->geoHandle.pointsArray_3d[i].x, as->geoHandle.pointsArray_3d[i].y, as->geoHandle.pointsArray_3d[i].z);
+                Vector3f rotated = rotateWithBasis(&as->geoHandle.pointsArray_3d[i * as->geoHandle.projectedStride], as->geoHandle.rotationBasis, &as->geoHandle.midPoint);
+                sprintf(pointText, "(%.3f, %.3f, %.3f)\0", rotated.x, rotated.y, rotated.z);
                 drawText(as->render, as->geoHandle.pointsArray[i].x + 2, as->geoHandle.pointsArray[i].y + 4, pointText);
             }
 
-            SDL_FPoint midPointMapped = map3dTo2d(&as->geoHandle.midPoint, &cameraPos, &cameraTarget, &cameraUp, FOV_Y_DEG, as->geoHandle.originXY.x, as->geoHandle.originXY.y, WIN_WIDTH, WIN_HEIGHT);
+            SDL_FPoint midPointMapped = map3dTo2d(&as->geoHandle.midPoint, &cameraPos, &cameraTarget, &cameraUp, FOV_Y_DEG, as->geoHandle.originXY.x, as->geoHandle.originXY.y, as->scaler.windowWidth, as->scaler.windowHeight);
 
             // Draws points' midpoint (i.e. point from which rotations happen) as a light blue square
             SDL_FRect rm = {
@@ -305,13 +690,50 @@ SDL_AppResult SDL_AppIterate(void* appstate) {
             char camPosInfoText[50];
             sprintf(camPosInfoText, "CAMERA AT (%.2f, %.2f, %.2f)", cameraPos.x, cameraPos.y, cameraPos.z);
             drawText(as->render, 4, 16, camPosInfoText);
+
+            char drawModeInfoText[80];
+            if (as->ioHandle.drawMode == DRAW_MODE_POLYLINE && as->tileCache == NULL) {
+                sprintf(drawModeInfoText, "[P] DRAW MODE: POLYLINE, %llu SEGMENTS SUBMITTED", (unsigned long long)submittedCount);
+            }
+            else {
+                sprintf(drawModeInfoText, "[P] DRAW MODE: POINTS, %llu POINTS SUBMITTED", (unsigned long long)submittedCount);
+            }
+            drawText(as->render, 4, 28, drawModeInfoText);
+
+            char scalingInfoText[80];
+            if (as->scaler.pointBudget == SDL_MAX_UINT64) {
+                sprintf(scalingInfoText, "FRAME: %.2f MS, RESOLUTION: %d%%, NO POINT BUDGET", as->scaler.frameTimeMs, (int)(as->scaler.renderScale * 100));
+            }
+            else {
+                sprintf(scalingInfoText, "FRAME: %.2f MS, RESOLUTION: %d%%, POINT BUDGET: %llu", as->scaler.frameTimeMs, (int)(as->scaler.renderScale * 100), (unsigned long long)as->scaler.pointBudget);
+            }
+            drawText(as->render, 4, 40, scalingInfoText);
+
+            if (as->tileCache != NULL) {
+                char tileInfoText[80];
+                sprintf(tileInfoText, "TILES: %u/%u IN MEMORY, %.1f/%.1f MB",
+                    as->tileCache->nResidentTiles, as->tileCache->header.nTiles,
+                    as->tileCache->residentBytes / (1024.0 * 1024.0), as->tileCache->maxResidentBytes / (1024.0 * 1024.0));
+                drawText(as->render, 4, 52, tileInfoText);
+            }
         }
         else {
             SDL_SetRenderDrawColor(as->render, 0xEE, 0xEE, 0xEE, 0xFF);
             drawText(as->render, 2, 2, "[TAB] TO TOGGLE DEBUG INFO");
         }
 
+        endScaledFrame(&as->scaler, as->render);
         SDL_RenderPresent(as->render);
+
+        double frameMs = (SDL_GetPerformanceCounter() - frameStart) * 1000.0 / SDL_GetPerformanceFrequency();
+        if (as->inputLog.isReplaying) {
+            CameraState state = getCameraState(as);
+            checkReplayedFrame(&as->inputLog, &state, &expectedState, frameMs);
+        }
+
+        // Lowering (or restoring) the internal resolution and point budget for the next frames
+        Uint64 nDrawablePoints = (as->tileCache != NULL) ? as->tileCache->header.nPoints : as->geoHandle.nPoints;
+        updateRenderScaler(&as->scaler, as->render, frameMs, !viewChanged, nDrawablePoints);
     }
 
     return SDL_APP_CONTINUE;
@@ -321,6 +743,14 @@ SDL_AppResult SDL_AppIterate(void* appstate) {
 void SDL_AppQuit(void* appstate, SDL_AppResult result) {
     Appstate* as = (Appstate*)appstate;
     SDL_free(as->geoHandle.pointsArray);
+    SDL_free(as->geoHandle.pointsArrayProjected);
     SDL_free(as->geoHandle.pointsArray_3d);
+    SDL_free(as->geoHandle.attributes.scalars);
+    SDL_free(as->geoHandle.attributes.colors);
+    destroyPointBatch(&as->pointBatch);
+    destroySimplifiedPolyline(&as->polyline);
+    closeInputLog(&as->inputLog);
+    closeTileCache(as->tileCache);
+    destroyRenderScaler(&as->scaler);
     SDL_free(appstate);
 }
\ No newline at end of file
@@ -0,0 +1,527 @@
+/*
+Golden test for the geometry kernels: compares map3dTo2d (and map3dTo2dWithBasis), rotateVector3f (and rotateWithBasis), the Vector3f.h helpers and the screen space functions
+against reference implementations that do all the math in double precision.
+
+Usage: GeometryGolden
+(build it together with the sources in lib/, like tools/BuildTiles.c)
+
+Errors in 3D are measured in ULPs (units in the last place) of the largest value involved, and errors in 2D in pixels.
+Every check prints a line with its worst error, and the program returns -1 if any of them fails
+*/
+#include <SDL3/SDL.h>
+#include <stdio.h>
+#include <math.h>
+
+#include "../include/Vector3f.h"
+#include "../include/GeometryMath.h"
+#include "../include/PointRendering.h"
+#include "../include/constants.h"
+
+#define RANDOM_SEED 20241019ull             // Seed for the random points (so that every run checks the same ones)
+#define N_RANDOM_CASES 10000u               // Number of random inputs for each check
+
+#define ARITHMETIC_MAX_ULPS 1.0             // add, subtract (a single rounding)
+#define PRODUCT_MAX_ULPS 4.0                // dotProduct, crossProduct, relative to the sum of the absolute values of the products
+#define UNITARY_MAX_ULPS 4.0                // createUnitaryVector
+#define ROTATION_MAX_ULPS 8.0               // rotateVector3f, relative to the largest coordinate of the point and the origin
+#define BASIS_ROTATION_MAX_ULPS 16.0        // rotateWithBasis after N_BASIS_ROTATIONS rotations of the basis (their errors add up)
+#define N_BASIS_ROTATIONS 100u              // Number of small rotations applied to the basis before using it
+#define MAP_MAX_ERROR_PX 0.01               // map3dTo2d for points in front of the camera
+#define SCREEN_MAX_ERROR_PX 0.001           // applyScreenTransform and translatePoints
+
+
+static unsigned nFailed = 0;
+
+
+/*
+Prints the result of a check and counts it if it failed
+*/
+static void report(const char* name, bool passed, double worstError, const char* unit) {
+    printf("%s %-48s worst error: %.4g %s\n", passed ? "PASS" : "FAIL", name, worstError, unit);
+    if (!passed) {
+        nFailed++;
+    }
+}
+
+/*
+Returns the distance between 'value' and the exact result 'expected', in ULPs of a float as big as 'scale'
+*/
+static double errorUlps(float value, double expected, double scale) {
+    float magnitude = (float)fabs(scale);
+    double ulp = (double)nextafterf(magnitude, INFINITY) - magnitude;
+    return fabs(value - expected) / ulp;
+}
+
+/*
+Returns a random float in [-range, range)
+*/
+static float randomCoordinate(float range) {
+    return (SDL_randf() * 2.f - 1.f) * range;
+}
+
+static Vector3f randomVector3f(float range) {
+    return makeVector3f(randomCoordinate(range), randomCoordinate(range), randomCoordinate(range));
+}
+
+
+/*
+REFERENCE IMPLEMENTATIONS: Same math as the kernels, with every operation done in double precision
+*/
+typedef struct {
+    double x;
+    double y;
+    double z;
+} Vector3d;
+
+static Vector3d toVector3d(const Vector3f* v) {
+    Vector3d out = { v->x, v->y, v->z };
+    return out;
+}
+
+static double refDot(const Vector3d* a, const Vector3d* b) {
+    return a->x * b->x + a->y * b->y + a->z * b->z;
+}
+
+static Vector3d refCross(const Vector3d* a, const Vector3d* b) {
+    Vector3d out = { a->y * b->z - a->z * b->y, a->z * b->x - a->x * b->z, a->x * b->y - a->y * b->x };
+    return out;
+}
+
+static Vector3d refUnitary(const Vector3d* v) {
+    double length = sqrt(refDot(v, v));
+    Vector3d out = { v->x / length, v->y / length, v->z / length };
+    return out;
+}
+
+/*
+Rotates p around origin (first around X, then Y, then Z), like rotateVector3f
+*/
+static Vector3d refRotate(Vector3d p, const Vector3d* origin, double x_deg, double y_deg, double z_deg) {
+    // The angles are converted with the same constant, so that only the precision of the math is compared
+    double xs = sin(x_deg * TO_RAD_CONSTANT), xc = cos(x_deg * TO_RAD_CONSTANT);
+    double ys = sin(y_deg * TO_RAD_CONSTANT), yc = cos(y_deg * TO_RAD_CONSTANT);
+    double zs = sin(z_deg * TO_RAD_CONSTANT), zc = cos(z_deg * TO_RAD_CONSTANT);
+
+    Vector3d r = { p.x - origin->x, p.y - origin->y, p.z - origin->z };
+    Vector3d t = { r.x, xc * r.y - xs * r.z, xs * r.y + xc * r.z };
+    r = t;
+    t = (Vector3d){ yc * r.x + ys * r.z, r.y, -ys * r.x + yc * r.z };
+    r = t;
+    t = (Vector3d){ zc * r.x - zs * r.y, zs * r.x + zc * r.y, r.z };
+
+    Vector3d out = { t.x + origin->x, t.y + origin->y, t.z + origin->z };
+    return out;
+}
+
+/*
+Maps a point to 2D like map3dTo2d, storing its coordinates in 'outXY' and its depth (as seen from the camera) in 'depth'
+*/
+static void refMap3dTo2d(const Vector3d* pt, const Vector3d* cameraPos, const Vector3d* cameraTarget, const Vector3d* cameraUp,
+    double y_fov_deg, double originX, double originY, int screenWidth, int screenHeight, double* depth, double outXY[2])
+{
+    Vector3d tempForward = { cameraTarget->x - cameraPos->x, cameraTarget->y - cameraPos->y, cameraTarget->z - cameraPos->z };
+    Vector3d forward = refUnitary(&tempForward);
+    Vector3d tempRight = refCross(cameraUp, &forward);
+    Vector3d right = refUnitary(&tempRight);
+    Vector3d up = refCross(&forward, &right);
+
+    Vector3d relative = { pt->x - cameraPos->x, pt->y - cameraPos->y, pt->z - cameraPos->z };
+    double x = refDot(&right, &relative);
+    double y = refDot(&up, &relative);
+    double z = refDot(&forward, &relative);
+
+    double f_y = screenHeight / tan(y_fov_deg * TO_RAD_CONSTANT);
+    double f_x = f_y * ((double)screenWidth / (double)screenHeight);
+
+    *depth = z;
+    outXY[0] = x * f_x / z + originX;
+    outXY[1] = -(originY + y * f_y / z);
+}
+
+/*
+Squared distance from p to the segment that goes from a to b
+*/
+static double refSegmentDistanceSq(const SDL_FPoint* p, const SDL_FPoint* a, const SDL_FPoint* b) {
+    double dx = (double)b->x - a->x, dy = (double)b->y - a->y;
+    double px = (double)p->x - a->x, py = (double)p->y - a->y;
+    double lengthSq = dx * dx + dy * dy;
+
+    double t = (lengthSq > 0.0) ? (px * dx + py * dy) / lengthSq : 0.0;
+    t = SDL_clamp(t, 0.0, 1.0);
+
+    double ex = px - t * dx, ey = py - t * dy;
+    return ex * ex + ey * ey;
+}
+
+
+/*
+TESTS
+*/
+static void testVectorHelpers(void) {
+    double worstArithmetic = 0.0, worstDot = 0.0, worstCross = 0.0, worstUnitary = 0.0;
+
+    for (unsigned i = 0; i < N_RANDOM_CASES; i++) {
+        Vector3f a = randomVector3f(1000.f);
+        Vector3f b = randomVector3f(1000.f);
+        Vector3d ad = toVector3d(&a), bd = toVector3d(&b);
+
+        Vector3f sum = add(&a, &b);
+        Vector3f difference = subtract(&a, &b);
+        const float* s = &sum.x;
+        const float* d = &difference.x;
+        const double* ac = &ad.x;
+        const double* bc = &bd.x;
+        for (unsigned c = 0; c < 3; c++) {
+            worstArithmetic = SDL_max(worstArithmetic, errorUlps(s[c], ac[c] + bc[c], ac[c] + bc[c]));
+            worstArithmetic = SDL_max(worstArithmetic, errorUlps(d[c], ac[c] - bc[c], ac[c] - bc[c]));
+        }
+
+        double dotScale = fabs(ad.x * bd.x) + fabs(ad.y * bd.y) + fabs(ad.z * bd.z);
+        worstDot = SDL_max(worstDot, errorUlps((float)dotProduct(&a, &b), refDot(&ad, &bd), dotScale));
+
+        Vector3f cross = crossProduct(&a, &b);
+        Vector3d crossRef = refCross(&ad, &bd);
+        worstCross = SDL_max(worstCross, errorUlps(cross.x, crossRef.x, fabs(ad.y * bd.z) + fabs(ad.z * bd.y)));
+        worstCross = SDL_max(worstCross, errorUlps(cross.y, crossRef.y, fabs(ad.z * bd.x) + fabs(ad.x * bd.z)));
+        worstCross = SDL_max(worstCross, errorUlps(cross.z, crossRef.z, fabs(ad.x * bd.y) + fabs(ad.y * bd.x)));
+
+        Vector3f unitary = createUnitaryVector(&a);
+        Vector3d unitaryRef = refUnitary(&ad);
+        worstUnitary = SDL_max(worstUnitary, errorUlps(unitary.x, unitaryRef.x, 1.0));
+        worstUnitary = SDL_max(worstUnitary, errorUlps(unitary.y, unitaryRef.y, 1.0));
+        worstUnitary = SDL_max(worstUnitary, errorUlps(unitary.z, unitaryRef.z, 1.0));
+    }
+
+    report("add / subtract", worstArithmetic <= ARITHMETIC_MAX_ULPS, worstArithmetic, "ULP");
+    report("dotProduct", worstDot <= PRODUCT_MAX_ULPS, worstDot, "ULP");
+    report("crossProduct", worstCross <= PRODUCT_MAX_ULPS, worstCross, "ULP");
+    report("createUnitaryVector", worstUnitary <= UNITARY_MAX_ULPS, worstUnitary, "ULP");
+
+    // Zero length input: has no direction, so the zero vector is returned instead of dividing by 0
+    Vector3f zero = makeVector3f(0, 0, 0);
+    Vector3f unitaryZero = createUnitaryVector(&zero);
+    report("createUnitaryVector (zero length input)", unitaryZero.x == 0.f && unitaryZero.y == 0.f && unitaryZero.z == 0.f, 0.0, "");
+}
+
+static void testRotation(void) {
+    double worstError = 0.0;
+
+    for (unsigned i = 0; i < N_RANDOM_CASES; i++) {
+        Vector3f p = randomVector3f(1000.f);
+        Vector3f origin = randomVector3f(100.f);
+        double x_deg = randomCoordinate(180.f), y_deg = randomCoordinate(180.f), z_deg = randomCoordinate(180.f);
+
+        Vector3d originRef = toVector3d(&origin);
+        Vector3d expected = refRotate(toVector3d(&p), &originRef, x_deg, y_deg, z_deg);
+        Vector3d relative = { p.x - originRef.x, p.y - originRef.y, p.z - originRef.z };
+        double scale = sqrt(refDot(&relative, &relative)) + SDL_max(fabs(origin.x), SDL_max(fabs(origin.y), fabs(origin.z)));
+
+        rotateVector3f(&p, &origin, x_deg, y_deg, z_deg);
+        worstError = SDL_max(worstError, errorUlps(p.x, expected.x, scale));
+        worstError = SDL_max(worstError, errorUlps(p.y, expected.y, scale));
+        worstError = SDL_max(worstError, errorUlps(p.z, expected.z, scale));
+    }
+    report("rotateVector3f", worstError <= ROTATION_MAX_ULPS, worstError, "ULP");
+
+    // No rotation at all: the point is left untouched
+    Vector3f p = makeVector3f(1.5f, -2.25f, 3.f);
+    Vector3f origin = makeVector3f(10.f, 20.f, 30.f);
+    bool rotated = rotateVector3f(&p, &origin, 0.0, 0.0, 0.0);
+    report("rotateVector3f (zero angles)", !rotated && p.x == 1.5f && p.y == -2.25f && p.z == 3.f, 0.0, "");
+
+    // Rotating with a basis that went through many rotations (like the one of the viewer) is the same as doing every rotation to the point
+    worstError = 0.0;
+    const Vector3f zero = makeVector3f(0, 0, 0);
+    for (unsigned i = 0; i < N_RANDOM_CASES / N_BASIS_ROTATIONS; i++) {
+        Vector3f basis[3] = { makeVector3f(1, 0, 0), makeVector3f(0, 1, 0), makeVector3f(0, 0, 1) };
+        Vector3f point = randomVector3f(1000.f);
+        Vector3f midPoint = randomVector3f(100.f);
+
+        Vector3d midPointRef = toVector3d(&midPoint);
+        Vector3d expected = toVector3d(&point);
+        for (unsigned j = 0; j < N_BASIS_ROTATIONS; j++) {
+            double x_deg = randomCoordinate(ANGLE_STEP_DEG), y_deg = randomCoordinate(ANGLE_STEP_DEG);
+            for (unsigned k = 0; k < 3; k++) {
+                rotateVector3f(&basis[k], &zero, x_deg, y_deg, 0.0);
+            }
+            expected = refRotate(expected, &midPointRef, x_deg, y_deg, 0.0);
+        }
+
+        Vector3d relative = { point.x - midPointRef.x, point.y - midPointRef.y, point.z - midPointRef.z };
+        double scale = sqrt(refDot(&relative, &relative)) + SDL_max(fabs(midPoint.x), SDL_max(fabs(midPoint.y), fabs(midPoint.z)));
+
+        Vector3f rotatedPoint = rotateWithBasis(&point, basis, &midPoint);
+        worstError = SDL_max(worstError, errorUlps(rotatedPoint.x, expected.x, scale));
+        worstError = SDL_max(worstError, errorUlps(rotatedPoint.y, expected.y, scale));
+        worstError = SDL_max(worstError, errorUlps(rotatedPoint.z, expected.z, scale));
+    }
+    report("rotateWithBasis", worstError <= BASIS_ROTATION_MAX_ULPS, worstError, "ULP");
+}
+
+static void testMapping(void) {
+    const Vector3f cameraPos = makeVector3f(DEFAULT_CAM_ZVALUE, DEFAULT_CAM_ZVALUE, DEFAULT_CAM_ZVALUE);
+    const Vector3f cameraTarget = makeVector3f(0, 0, 0);
+    const Vector3f cameraUp = makeVector3f(0, 1, 0);
+    const Vector3d cameraPosRef = toVector3d(&cameraPos), cameraTargetRef = toVector3d(&cameraTarget), cameraUpRef = toVector3d(&cameraUp);
+    const float originX = DEFAULT_ORIGIN_X(WIN_WIDTH), originY = DEFAULT_ORIGIN_Y(WIN_HEIGHT);
+
+    double worstError = 0.0;
+    for (unsigned i = 0; i < N_RANDOM_CASES; i++) {
+        Vector3f p = randomVector3f(100.f);
+        Vector3d pRef = toVector3d(&p);
+
+        double depth, expected[2];
+        refMap3dTo2d(&pRef, &cameraPosRef, &cameraTargetRef, &cameraUpRef, FOV_Y_DEG, originX, originY, WIN_WIDTH, WIN_HEIGHT, &depth, expected);
+        SDL_FPoint mapped = map3dTo2d(&p, &cameraPos, &cameraTarget, &cameraUp, FOV_Y_DEG, originX, originY, WIN_WIDTH, WIN_HEIGHT);
+
+        worstError = SDL_max(worstError, hypot(mapped.x - expected[0], mapped.y - expected[1]));
+    }
+    report("map3dTo2d", worstError <= MAP_MAX_ERROR_PX, worstError, "px");
+
+    // Mapping with a camera basis calculated once has to give exactly the same result as calculating it for every point
+    const CameraBasis camera = makeCameraBasis(&cameraPos, &cameraTarget, &cameraUp, FOV_Y_DEG, WIN_WIDTH, WIN_HEIGHT);
+    bool isSame = true;
+    for (unsigned i = 0; i < N_RANDOM_CASES; i++) {
+        Vector3f p = randomVector3f(100.f);
+        SDL_FPoint mapped = map3dTo2d(&p, &cameraPos, &cameraTarget, &cameraUp, FOV_Y_DEG, originX, originY, WIN_WIDTH, WIN_HEIGHT);
+        SDL_FPoint mappedWithBasis = map3dTo2dWithBasis(&p, &camera, originX, originY);
+        isSame = isSame && mapped.x == mappedWithBasis.x && mapped.y == mappedWithBasis.y;
+    }
+    report("map3dTo2dWithBasis (same as map3dTo2d)", isSame, 0.0, "");
+
+    // A point at the position of the camera (or anywhere in the plane of the camera) has no 2D position: callers have to discard it
+    Vector3f inCameraPlane = add(&cameraPos, &(Vector3f){ 1.f, 0.f, -1.f });
+    SDL_FPoint atCamera = map3dTo2d(&cameraPos, &cameraPos, &cameraTarget, &cameraUp, FOV_Y_DEG, originX, originY, WIN_WIDTH, WIN_HEIGHT);
+    SDL_FPoint inPlane = map3dTo2d(&inCameraPlane, &cameraPos, &cameraTarget, &cameraUp, FOV_Y_DEG, originX, originY, WIN_WIDTH, WIN_HEIGHT);
+    report("map3dTo2d (point at the camera)", !isfinite(atCamera.x) && !isfinite(atCamera.y), 0.0, "");
+    report("map3dTo2d (point in the camera plane)", !isfinite(inPlane.x), 0.0, "");
+
+    // A point behind the camera is mapped as if it was mirrored through the camera (so it has to be discarded by the caller as well)
+    Vector3f front = makeVector3f(50.f, 80.f, -20.f);
+    Vector3f behind = makeVector3f(2 * cameraPos.x - front.x, 2 * cameraPos.y - front.y, 2 * cameraPos.z - front.z);
+    Vector3d behindRef = toVector3d(&behind);
+    double depth, expected[2];
+    refMap3dTo2d(&behindRef, &cameraPosRef, &cameraTargetRef, &cameraUpRef, FOV_Y_DEG, originX, originY, WIN_WIDTH, WIN_HEIGHT, &depth, expected);
+    SDL_FPoint frontMapped = map3dTo2d(&front, &cameraPos, &cameraTarget, &cameraUp, FOV_Y_DEG, originX, originY, WIN_WIDTH, WIN_HEIGHT);
+    SDL_FPoint behindMapped = map3dTo2d(&behind, &cameraPos, &cameraTarget, &cameraUp, FOV_Y_DEG, originX, originY, WIN_WIDTH, WIN_HEIGHT);
+
+    double behindError = hypot(behindMapped.x - expected[0], behindMapped.y - expected[1]);
+    double mirrorError = hypot(behindMapped.x - frontMapped.x, behindMapped.y - frontMapped.y);
+    report("map3dTo2d (point behind the camera)", depth < 0.0 && behindError <= MAP_MAX_ERROR_PX && mirrorError <= MAP_MAX_ERROR_PX, SDL_max(behindError, mirrorError), "px");
+}
+
+static void testScreenTransform(void) {
+    const Vector3f cameraPos = makeVector3f(DEFAULT_CAM_ZVALUE, DEFAULT_CAM_ZVALUE, DEFAULT_CAM_ZVALUE);
+    const Vector3f cameraTarget = makeVector3f(0, 0, 0);
+    const Vector3f cameraUp = makeVector3f(0, 1, 0);
+    const float originX = 321.5f, originY = -123.25f;
+
+    // With a scale of 1, mapping with (0, 0) as the origin and then moving the points is the same as mapping with the origin
+    SDL_FPoint projected[256], transformed[256], expected[256];
+    for (unsigned i = 0; i < 256; i++) {
+        Vector3f p = randomVector3f(100.f);
+        projected[i] = map3dTo2d(&p, &cameraPos, &cameraTarget, &cameraUp, FOV_Y_DEG, 0.f, 0.f, WIN_WIDTH, WIN_HEIGHT);
+        expected[i] = map3dTo2d(&p, &cameraPos, &cameraTarget, &cameraUp, FOV_Y_DEG, originX, originY, WIN_WIDTH, WIN_HEIGHT);
+    }
+    applyScreenTransform(projected, transformed, 256, 1.f, originX, originY);
+
+    double worstError = 0.0;
+    for (unsigned i = 0; i < 256; i++) {
+        worstError = SDL_max(worstError, hypot(transformed[i].x - expected[i].x, transformed[i].y - expected[i].y));
+    }
+    report("applyScreenTransform (same as map3dTo2d)", worstError <= SCREEN_MAX_ERROR_PX, worstError, "px");
+
+    // Any scale, against the transformation done in double precision
+    worstError = 0.0;
+    for (unsigned i = 0; i < 256; i++) {
+        float scale = 0.25f + SDL_randf() * 4.f;
+        applyScreenTransform(&projected[i], &transformed[i], 1, scale, originX, originY);
+
+        double x = (double)projected[i].x * scale + originX;
+        double y = (double)projected[i].y * scale - originY;
+        worstError = SDL_max(worstError, hypot(transformed[i].x - x, transformed[i].y - y));
+    }
+    report("applyScreenTransform (scaled)", worstError <= SCREEN_MAX_ERROR_PX, worstError, "px");
+
+    // Moving the points by the difference between two origins is the same as transforming them with the second one
+    applyScreenTransform(projected, transformed, 256, 2.f, originX, originY);
+    applyScreenTransform(projected, expected, 256, 2.f, originX + 40.f, originY + 15.f);
+    translatePoints(transformed, 256, 40.f, -15.f);
+
+    worstError = 0.0;
+    for (unsigned i = 0; i < 256; i++) {
+        worstError = SDL_max(worstError, hypot(transformed[i].x - expected[i].x, transformed[i].y - expected[i].y));
+    }
+    report("translatePoints", worstError <= SCREEN_MAX_ERROR_PX, worstError, "px");
+}
+
+static void testZoomScaling(void) {
+    const Vector3d cameraTarget = { 0.0, 0.0, 0.0 };
+    const Vector3d cameraUp = { 0.0, 1.0, 0.0 };
+    const double radii[] = { 1.0, 10.0, 50.0, 100.0, 300.0 };
+    const double distances[] = { 400.0, 600.0, 1000.0, 1039.23, 2000.0 };
+
+    // Points on the surface of the bounding sphere (including its extremes towards and away from the camera)
+    Vector3d samples[514];
+    unsigned nSamples = 0;
+    for (unsigned i = 0; i < 512; i++) {
+        double z = 1.0 - 2.0 * (i + 0.5) / 512;
+        double ring = sqrt(1.0 - z * z);
+        double angle = i * 2.39996322972865332;     // Golden angle
+        samples[nSamples++] = (Vector3d){ ring * cos(angle), ring * sin(angle), z };
+    }
+    samples[nSamples++] = (Vector3d){ 1.0, 0.0, 0.0 };
+    samples[nSamples++] = (Vector3d){ 0.0, 1.0, 0.0 };
+
+    /*
+    Whenever the zoom is considered scalable, the real error of scaling the mapped points must be within the tolerance.
+    The camera looks along -Z, so the scale used by the viewer (old distance / new distance) is exact at the depth of the target
+    */
+    double worstError = 0.0;
+    unsigned nScalable = 0;
+    bool isSound = true;
+    for (unsigned r = 0; r < SDL_arraysize(radii); r++) {
+        for (unsigned d = 0; d < SDL_arraysize(distances); d++) {
+            // Zooms in and out in small steps, so that some of them are close to the largest zoom that can be scaled
+            for (int z = -200; z <= 200; z++) {
+                double oldDistance = distances[d];
+                double newDistance = distances[d] * (1.0 + z * 0.0005);
+                if (!isZoomScalable((float)radii[r], oldDistance, newDistance, FOV_Y_DEG, WIN_WIDTH, WIN_HEIGHT, ZOOM_SCALE_TOLERANCE_PX)) {
+                    continue;
+                }
+                nScalable++;
+
+                Vector3d oldCamera = { 0.0, 0.0, oldDistance };
+                Vector3d newCamera = { 0.0, 0.0, newDistance };
+                for (unsigned i = 0; i < nSamples; i++) {
+                    Vector3d p = { samples[i].x * radii[r], samples[i].y * radii[r], samples[i].z * radii[r] };
+                    double depth, oldXY[2], newXY[2];
+                    refMap3dTo2d(&p, &oldCamera, &cameraTarget, &cameraUp, FOV_Y_DEG, 0.0, 0.0, WIN_WIDTH, WIN_HEIGHT, &depth, oldXY);
+                    refMap3dTo2d(&p, &newCamera, &cameraTarget, &cameraUp, FOV_Y_DEG, 0.0, 0.0, WIN_WIDTH, WIN_HEIGHT, &depth, newXY);
+
+                    double scale = oldDistance / newDistance;
+                    double error = hypot(oldXY[0] * scale - newXY[0], oldXY[1] * scale - newXY[1]);
+                    worstError = SDL_max(worstError, error);
+                    isSound = isSound && error <= ZOOM_SCALE_TOLERANCE_PX;
+                }
+            }
+        }
+    }
+    // If no zoom was ever scalable the check above would pass without testing anything
+    report("isZoomScalable (error within tolerance)", isSound && nScalable > 0, worstError, "px");
+
+    // If the camera is (or could end up) inside the bounding sphere, some points could be at or behind it
+    bool rejectsInside = !isZoomScalable(100.f, 100.0, 200.0, FOV_Y_DEG, WIN_WIDTH, WIN_HEIGHT, ZOOM_SCALE_TOLERANCE_PX)
+        && !isZoomScalable(100.f, 200.0, 50.0, FOV_Y_DEG, WIN_WIDTH, WIN_HEIGHT, ZOOM_SCALE_TOLERANCE_PX);
+    report("isZoomScalable (camera inside the bounding sphere)", rejectsInside, 0.0, "");
+
+    bool acceptsNoZoom = isZoomScalable(100.f, 1000.0, 1000.0, FOV_Y_DEG, WIN_WIDTH, WIN_HEIGHT, ZOOM_SCALE_TOLERANCE_PX);
+    report("isZoomScalable (same distance)", acceptsNoZoom, 0.0, "");
+}
+
+/*
+Checks that 'polyline' is a simplified version of 'points': its vertices are some of the original ones (in the same order), both ends are kept,
+and every original vertex is within 'maxDistance' pixels of the simplified segment that replaces it. Returns the largest distance in 'worstDistance'
+*/
+static bool isValidSimplification(const SimplifiedPolyline* polyline, const SDL_FPoint points[], unsigned long count, double maxDistance, double* worstDistance) {
+    *worstDistance = 0.0;
+    if (count == 0) {
+        return polyline->nPoints == 0;
+    }
+    if (polyline->nPoints < SDL_min(count, 2ul)) {
+        return false;
+    }
+
+    const SDL_FPoint* out = polyline->points;
+    if (out[0].x != points[0].x || out[0].y != points[0].y
+        || out[polyline->nPoints - 1].x != points[count - 1].x || out[polyline->nPoints - 1].y != points[count - 1].y) {
+        return false;
+    }
+
+    // Walking the original polyline, matching each simplified vertex with the next original vertex equal to it
+    unsigned long segment = 0;
+    for (unsigned long i = 0; i < count; i++) {
+        if (segment + 1 < polyline->nPoints && points[i].x == out[segment + 1].x && points[i].y == out[segment + 1].y) {
+            segment++;
+        }
+
+        const SDL_FPoint* end = &out[SDL_min(segment + 1, polyline->nPoints - 1)];
+        *worstDistance = SDL_max(*worstDistance, sqrt(refSegmentDistanceSq(&points[i], &out[segment], end)));
+    }
+
+    return segment == polyline->nPoints - 1 && *worstDistance <= maxDistance;
+}
+
+static void testSimplification(void) {
+    const unsigned long count = 20000;
+    SDL_FPoint* points = (SDL_FPoint*)SDL_calloc(count, sizeof(SDL_FPoint));
+    SimplifiedPolyline polyline;
+    if (points == NULL || !createSimplifiedPolyline(&polyline, count)) {
+        perror("Unable to allocate memory for the polylines\n");
+        exit(-1);
+    }
+
+    /*
+    Merging vertices closer than the tolerance and then dropping the ones within the tolerance of the simplified segments can add up,
+    so the simplified polyline is allowed to be up to twice the tolerance away from the original
+    */
+    const double maxDistance = 2.0 * SIMPLIFY_TOLERANCE_PX;
+    double worstDistance;
+
+    // Random walk with steps of every size (sub-pixel ones included)
+    points[0] = (SDL_FPoint){ 500.f, 300.f };
+    for (unsigned long i = 1; i < count; i++) {
+        float step = (i % 100 < 50) ? 0.2f : 5.f;
+        points[i] = (SDL_FPoint){ points[i - 1].x + randomCoordinate(step), points[i - 1].y + randomCoordinate(step) };
+    }
+    simplifyPolyline(&polyline, points, count, SIMPLIFY_TOLERANCE_PX);
+    bool isValid = isValidSimplification(&polyline, points, count, maxDistance, &worstDistance);
+    report("simplifyPolyline (random walk)", isValid && polyline.nPoints < count, worstDistance, "px");
+
+    // Collinear vertices: only the ends are needed
+    for (unsigned long i = 0; i < count; i++) {
+        points[i] = (SDL_FPoint){ 10.f + i * 0.05f, 20.f + i * 0.025f };
+    }
+    simplifyPolyline(&polyline, points, count, SIMPLIFY_TOLERANCE_PX);
+    isValid = isValidSimplification(&polyline, points, count, maxDistance, &worstDistance);
+    report("simplifyPolyline (straight line)", isValid && polyline.nPoints == 2, worstDistance, "px");
+
+    // Zig-zag much larger than the tolerance: every vertex is needed
+    for (unsigned long i = 0; i < 1000; i++) {
+        points[i] = (SDL_FPoint){ i * 4.f, (i % 2) ? 10.f : 0.f };
+    }
+    simplifyPolyline(&polyline, points, 1000, SIMPLIFY_TOLERANCE_PX);
+    isValid = isValidSimplification(&polyline, points, 1000, maxDistance, &worstDistance);
+    report("simplifyPolyline (zig-zag)", isValid && polyline.nPoints == 1000, worstDistance, "px");
+
+    // Polylines too short to be simplified are copied as they are
+    bool copiesShort = true;
+    for (unsigned long n = 0; n < 3; n++) {
+        simplifyPolyline(&polyline, points, n, SIMPLIFY_TOLERANCE_PX);
+        copiesShort = copiesShort && polyline.nPoints == n && isValidSimplification(&polyline, points, n, 0.0, &worstDistance);
+    }
+    report("simplifyPolyline (0, 1 and 2 vertices)", copiesShort, 0.0, "");
+
+    destroySimplifiedPolyline(&polyline);
+    SDL_free(points);
+}
+
+
+int main(void) {
+    SDL_srand(RANDOM_SEED);
+
+    testVectorHelpers();
+    testRotation();
+    testMapping();
+    testScreenTransform();
+    testZoomScaling();
+    testSimplification();
+
+    if (nFailed > 0) {
+        printf("%u checks failed\n", nFailed);
+        return -1;
+    }
+
+    printf("All checks passed\n");
+    return 0;
+}
@@ -0,0 +1,397 @@
+/*
+Preprocessing tool that converts a text points file into a tiled points file that the viewer can open without loading it all in memory.
+
+Usage: BuildTiles <input points file> <output tiled file>
+
+The points are split into a grid of spatial chunks (tiles) so that the viewer only has to read the ones the camera can see.
+The input is streamed 3 times (bounds, tile sizes and points) so that the memory used doesn't depend on the number of points
+(plus once more every time the cells with too many points are split, if the points are spread very unevenly)
+*/
+#include <SDL3/SDL.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "../include/FileParsing.h"
+#include "../include/TiledCloud.h"
+
+#define TILE_WRITE_BUFFER_POINTS 64u        // Points of each tile that are gathered in memory before writing them to the output file
+#define MAX_SPLIT_DEPTH 8u                  // Maximum number of times a cell (and then the cells it is split into) can be split
+
+
+/*
+Grid that splits a box into cells. The first grid covers all the points, and the cells that end up with too many points are split by grids of their own
+*/
+typedef struct {
+    Vector3f minCorner;         // Corners of the box covered by the grid
+    Vector3f maxCorner;
+    unsigned gridSize[3];       // Number of cells along each axis
+    Uint32 firstCell;           // Position of the first cell of the grid in the array of cells
+    unsigned depth;             // Number of grids above this one
+} CellGrid;
+
+typedef struct {
+    TileIndexEntry entry;       // Bounds and number of the points in the cell
+    Uint32 childGrid;           // Grid that splits the cell (0 if the cell isn't split, as grid 0 can't be anyone's child)
+    Uint32 tile;                // Tile that the cell becomes (only for cells that are not split and have points)
+} GridCell;
+
+typedef struct {
+    CellGrid* grids;
+    Uint32 nGrids;
+    GridCell* cells;
+    Uint32 nCells;
+} CellTree;
+
+
+typedef struct {
+    FILE* file;                 // Text file with the points
+    unsigned long lineNum;      // Number of the line that was read last (for error messages)
+    char line[128];             // Last line read
+} PointStream;
+
+/*
+Opens the text file specified by 'fname' so that its points can be read one by one
+*/
+static bool openPointStream(PointStream* stream, const char* fname) {
+    fopen_s(&stream->file, fname, "r");
+    stream->lineNum = 0;
+    return stream->file != NULL;
+}
+
+/*
+Reads the next point of the stream into p. Returns false when there are no more points
+*/
+static bool nextPoint(PointStream* stream, Vector3f* p) {
+    while (fgets(stream->line, 128, stream->file) != NULL) {
+        stream->lineNum++;
+
+        // Skipping empty lines (i.e. the one at the end of the file)
+        if (strchr(stream->line, ',') == NULL) {
+            continue;
+        }
+
+        *p = strToVector3f(stream->line, stream->lineNum);
+        return true;
+    }
+
+    return false;
+}
+
+/*
+Moves the stream back to the first point
+*/
+static void rewindPointStream(PointStream* stream) {
+    fseek(stream->file, 0, SEEK_SET);
+    stream->lineNum = 0;
+}
+
+/*
+Returns the position of the grid cell along one axis for coordinate 'value'
+*/
+static unsigned cellAlongAxis(float value, float minValue, float maxValue, unsigned gridSize) {
+    if (maxValue <= minValue) {
+        return 0;
+    }
+
+    unsigned cell = (unsigned)((value - minValue) / (maxValue - minValue) * gridSize);
+    return (cell >= gridSize) ? gridSize - 1 : cell;
+}
+
+/*
+Calculates the number of cells along each axis so that a grid covering the box between both corners has about 'nCells' cells and they are (roughly) cubes.
+Axes along which the points take less space than a cell get a single cell, so that flat scans don't leave most of the cells empty
+*/
+static void sizeGrid(const Vector3f* minCorner, const Vector3f* maxCorner, double nCells, unsigned gridSize[3]) {
+    const double extents[3] = {
+        (double)maxCorner->x - minCorner->x,
+        (double)maxCorner->y - minCorner->y,
+        (double)maxCorner->z - minCorner->z
+    };
+
+    bool isSplit[3];
+    for (unsigned i = 0; i < 3; i++) {
+        gridSize[i] = 1;
+        isSplit[i] = extents[i] > 0.0;
+    }
+
+    while (true) {
+        // Edge of the cubes that split the axes left into 'nCells' cells
+        double volume = 1.0;
+        unsigned nSplit = 0;
+        for (unsigned i = 0; i < 3; i++) {
+            if (isSplit[i]) {
+                volume *= extents[i];
+                nSplit++;
+            }
+        }
+        if (nSplit == 0) {
+            return;
+        }
+        double edge = pow(volume / SDL_max(nCells, 1.0), 1.0 / nSplit);
+
+        // If an axis is shorter than the edge it isn't split, and the cells have to be shared by the other axes
+        bool isDone = true;
+        for (unsigned i = 0; i < 3; i++) {
+            if (isSplit[i] && extents[i] < edge) {
+                isSplit[i] = false;
+                isDone = false;
+            }
+        }
+
+        if (isDone) {
+            for (unsigned i = 0; i < 3; i++) {
+                if (isSplit[i]) {
+                    gridSize[i] = SDL_clamp((unsigned)ceil(extents[i] / edge), 1u, TILE_GRID_MAX);
+                }
+            }
+            return;
+        }
+    }
+}
+
+/*
+Adds to the tree a grid of about 'nCells' empty cells that covers the box between both corners. Returns false if the memory could not be allocated
+*/
+static bool addGrid(CellTree* tree, const Vector3f* minCorner, const Vector3f* maxCorner, double nCells, unsigned depth) {
+    CellGrid grid;
+    grid.minCorner = *minCorner;
+    grid.maxCorner = *maxCorner;
+    grid.firstCell = tree->nCells;
+    grid.depth = depth;
+    sizeGrid(minCorner, maxCorner, nCells, grid.gridSize);
+
+    const Uint32 nNewCells = grid.gridSize[0] * grid.gridSize[1] * grid.gridSize[2];
+    CellGrid* grids = (CellGrid*)SDL_realloc(tree->grids, (tree->nGrids + 1) * sizeof(CellGrid));
+    GridCell* cells = (GridCell*)SDL_realloc(tree->cells, (tree->nCells + nNewCells) * sizeof(GridCell));
+    if (grids != NULL) {
+        tree->grids = grids;
+    }
+    if (cells != NULL) {
+        tree->cells = cells;
+    }
+    if (grids == NULL || cells == NULL) {
+        return false;
+    }
+
+    memset(&tree->cells[tree->nCells], 0, nNewCells * sizeof(GridCell));
+    tree->grids[tree->nGrids] = grid;
+    tree->nGrids++;
+    tree->nCells += nNewCells;
+    return true;
+}
+
+/*
+Returns the index of the cell (that isn't split) in which point p is
+*/
+static Uint32 cellOfPoint(const CellTree* tree, const Vector3f* p) {
+    const CellGrid* grid = &tree->grids[0];
+
+    while (true) {
+        unsigned x = cellAlongAxis(p->x, grid->minCorner.x, grid->maxCorner.x, grid->gridSize[0]);
+        unsigned y = cellAlongAxis(p->y, grid->minCorner.y, grid->maxCorner.y, grid->gridSize[1]);
+        unsigned z = cellAlongAxis(p->z, grid->minCorner.z, grid->maxCorner.z, grid->gridSize[2]);
+        Uint32 cell = grid->firstCell + (z * grid->gridSize[1] + y) * grid->gridSize[0] + x;
+
+        if (tree->cells[cell].childGrid == 0) {
+            return cell;
+        }
+        grid = &tree->grids[tree->cells[cell].childGrid];
+    }
+}
+
+/*
+Writes the points gathered in the buffer of tile 't' to their place in the output file. Returns false if they could not be written
+*/
+static bool flushTileBuffer(SDL_IOStream* out, const Vector3f* buffers, Uint32* bufferCounts, Uint64* writeOffsets, Uint32 t) {
+    if (bufferCounts[t] == 0) {
+        return true;
+    }
+
+    size_t bytes = bufferCounts[t] * sizeof(Vector3f);
+    if (SDL_SeekIO(out, (Sint64)writeOffsets[t], SDL_IO_SEEK_SET) < 0
+        || SDL_WriteIO(out, &buffers[(size_t)t * TILE_WRITE_BUFFER_POINTS], bytes) != bytes) {
+        SDL_Log("Couldn't write output file: %s", SDL_GetError());
+        return false;
+    }
+
+    writeOffsets[t] += bytes;
+    bufferCounts[t] = 0;
+    return true;
+}
+
+
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        printf("Usage: %s <input points file> <output tiled file>\n", argv[0]);
+        return -1;
+    }
+
+    PointStream stream;
+    if (!openPointStream(&stream, argv[1])) {
+        perror("Unable to read input file\n");
+        return -1;
+    }
+
+    // FIRST PASS: Bounds, number of points and average point
+    TiledFileHeader header;
+    memset(&header, 0, sizeof(TiledFileHeader));
+    memcpy(header.magic, TILED_FILE_MAGIC, 4);
+
+    double sumX = 0.0, sumY = 0.0, sumZ = 0.0;
+    Vector3f p;
+    while (nextPoint(&stream, &p)) {
+        if (header.nPoints == 0) {
+            header.minCorner = header.maxCorner = p;
+        }
+        header.minCorner = makeVector3f(SDL_min(header.minCorner.x, p.x), SDL_min(header.minCorner.y, p.y), SDL_min(header.minCorner.z, p.z));
+        header.maxCorner = makeVector3f(SDL_max(header.maxCorner.x, p.x), SDL_max(header.maxCorner.y, p.y), SDL_max(header.maxCorner.z, p.z));
+
+        sumX += p.x;
+        sumY += p.y;
+        sumZ += p.z;
+        header.nPoints++;
+    }
+
+    if (header.nPoints == 0) {
+        printf("No points found in '%s'\n", argv[1]);
+        return -1;
+    }
+    header.midPoint = makeVector3f((float)(sumX / header.nPoints), (float)(sumY / header.nPoints), (float)(sumZ / header.nPoints));
+
+    /*
+    SECOND PASS: Number of points and bounds of every cell.
+    The grid aims for TILE_TARGET_POINTS points per cell, but if the points are spread unevenly some cells can end up with many more.
+    Those cells are split by a finer grid and the points are counted again, so that no tile is too big to be loaded by the viewer
+    */
+    CellTree tree = { NULL, 0, NULL, 0 };
+    if (!addGrid(&tree, &header.minCorner, &header.maxCorner, (double)header.nPoints / TILE_TARGET_POINTS, 0)) {
+        perror("Unable to allocate memory for the grid\n");
+        return -1;
+    }
+
+    while (true) {
+        for (Uint32 cell = 0; cell < tree.nCells; cell++) {
+            tree.cells[cell].entry.nPoints = 0;
+        }
+
+        rewindPointStream(&stream);
+        while (nextPoint(&stream, &p)) {
+            TileIndexEntry* entry = &tree.cells[cellOfPoint(&tree, &p)].entry;
+
+            if (entry->nPoints == 0) {
+                entry->minCorner = entry->maxCorner = p;
+            }
+            entry->minCorner = makeVector3f(SDL_min(entry->minCorner.x, p.x), SDL_min(entry->minCorner.y, p.y), SDL_min(entry->minCorner.z, p.z));
+            entry->maxCorner = makeVector3f(SDL_max(entry->maxCorner.x, p.x), SDL_max(entry->maxCorner.y, p.y), SDL_max(entry->maxCorner.z, p.z));
+            entry->nPoints++;
+        }
+
+        // Splitting the cells with too many points (unless all their points are in the same place, or they were split too many times already)
+        bool isAnySplit = false;
+        const Uint32 nGrids = tree.nGrids;
+        for (Uint32 g = 0; g < nGrids; g++) {
+            const Uint32 nGridCells = tree.grids[g].gridSize[0] * tree.grids[g].gridSize[1] * tree.grids[g].gridSize[2];
+            const unsigned depth = tree.grids[g].depth;
+
+            for (Uint32 cell = tree.grids[g].firstCell; cell < tree.grids[g].firstCell + nGridCells; cell++) {
+                const TileIndexEntry entry = tree.cells[cell].entry;
+                bool isSinglePosition = entry.minCorner.x == entry.maxCorner.x && entry.minCorner.y == entry.maxCorner.y && entry.minCorner.z == entry.maxCorner.z;
+                if (tree.cells[cell].childGrid != 0 || entry.nPoints <= TILE_MAX_POINTS || isSinglePosition || depth >= MAX_SPLIT_DEPTH) {
+                    continue;
+                }
+
+                tree.cells[cell].childGrid = tree.nGrids;
+                if (!addGrid(&tree, &entry.minCorner, &entry.maxCorner, (double)entry.nPoints / TILE_TARGET_POINTS, depth + 1)) {
+                    perror("Unable to allocate memory for the grid\n");
+                    return -1;
+                }
+                isAnySplit = true;
+            }
+        }
+
+        if (!isAnySplit) {
+            break;
+        }
+    }
+
+    // Empty cells (and the ones that were split) don't become tiles, so only the rest are put in the index and the position of every tile in the file is decided
+    for (Uint32 cell = 0; cell < tree.nCells; cell++) {
+        if (tree.cells[cell].childGrid == 0 && tree.cells[cell].entry.nPoints > 0) {
+            header.nTiles++;
+        }
+    }
+
+    TileIndexEntry* index = (TileIndexEntry*)SDL_calloc(header.nTiles > 0 ? header.nTiles : 1, sizeof(TileIndexEntry));
+    if (index == NULL) {
+        perror("Unable to allocate memory for the tile index\n");
+        return -1;
+    }
+
+    Uint64 offset = sizeof(TiledFileHeader) + (Uint64)header.nTiles * sizeof(TileIndexEntry);
+    Uint32 tile = 0;
+    for (Uint32 cell = 0; cell < tree.nCells; cell++) {
+        if (tree.cells[cell].childGrid != 0 || tree.cells[cell].entry.nPoints == 0) {
+            continue;
+        }
+
+        index[tile] = tree.cells[cell].entry;
+        index[tile].offset = offset;
+        index[tile].reserved = 0;
+        offset += (Uint64)index[tile].nPoints * sizeof(Vector3f);
+
+        tree.cells[cell].tile = tile;
+        tile++;
+    }
+    printf("Split the points with %u grids into %u tiles\n", tree.nGrids, header.nTiles);
+
+    SDL_IOStream* out = SDL_IOFromFile(argv[2], "wb");
+    if (out == NULL
+        || SDL_WriteIO(out, &header, sizeof(TiledFileHeader)) != sizeof(TiledFileHeader)
+        || SDL_WriteIO(out, index, header.nTiles * sizeof(TileIndexEntry)) != header.nTiles * sizeof(TileIndexEntry)) {
+        SDL_Log("Couldn't write output file: %s", SDL_GetError());
+        return -1;
+    }
+
+    // THIRD PASS: Writing the points of every tile in its place, gathering a few of them first to avoid writing them one by one
+    Vector3f* buffers = (Vector3f*)SDL_calloc((size_t)header.nTiles * TILE_WRITE_BUFFER_POINTS, sizeof(Vector3f));
+    Uint32* bufferCounts = (Uint32*)SDL_calloc(header.nTiles, sizeof(Uint32));
+    Uint64* writeOffsets = (Uint64*)SDL_calloc(header.nTiles, sizeof(Uint64));
+    if (buffers == NULL || bufferCounts == NULL || writeOffsets == NULL) {
+        perror("Unable to allocate memory for the write buffers\n");
+        return -1;
+    }
+    for (Uint32 i = 0; i < header.nTiles; i++) {
+        writeOffsets[i] = index[i].offset;
+    }
+
+    rewindPointStream(&stream);
+    while (nextPoint(&stream, &p)) {
+        Uint32 t = tree.cells[cellOfPoint(&tree, &p)].tile;
+        buffers[(size_t)t * TILE_WRITE_BUFFER_POINTS + bufferCounts[t]] = p;
+        bufferCounts[t]++;
+
+        if (bufferCounts[t] == TILE_WRITE_BUFFER_POINTS && !flushTileBuffer(out, buffers, bufferCounts, writeOffsets, t)) {
+            return -1;
+        }
+    }
+
+    // Writing the points that were left in the buffers
+    for (Uint32 i = 0; i < header.nTiles; i++) {
+        if (!flushTileBuffer(out, buffers, bufferCounts, writeOffsets, i)) {
+            return -1;
+        }
+    }
+
+    SDL_CloseIO(out);
+    fclose(stream.file);
+
+    printf("Wrote %llu points in %u tiles to '%s'\n", (unsigned long long)header.nPoints, header.nTiles, argv[2]);
+
+    SDL_free(tree.grids);
+    SDL_free(tree.cells);
+    SDL_free(index);
+    SDL_free(buffers);
+    SDL_free(bufferCounts);
+    SDL_free(writeOffsets);
+    return 0;
+}